@@ -0,0 +1,38 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include <cmath>
+#include <glm/glm.hpp>
+
+// Axis aligned bounding box
+struct AABB {
+    glm::vec3 min;
+    glm::vec3 max;
+
+    glm::vec3 get_center() const {
+        return (min + max) * 0.5f;
+    }
+
+    // box around this box after transforming it (Arvo: the extent along each axis sums the
+    // absolute matrix entries)
+    AABB transformed(const glm::mat4& matrix) const {
+        glm::vec3 center = glm::vec3(matrix * glm::vec4(get_center(), 1.0f));
+        glm::vec3 extent = (max - min) * 0.5f;
+        glm::vec3 new_extent(0.0f);
+        for (int column = 0; column < 3; column++) {
+            new_extent += glm::abs(glm::vec3(matrix[column])) * extent[column];
+        }
+        return {center - new_extent, center + new_extent};
+    }
+
+    float distance_squared(const glm::vec3& point) const {
+        glm::vec3 offset = glm::clamp(point, min, max) - point;
+        return glm::dot(offset, offset);
+    }
+
+    bool intersects_sphere(const glm::vec3& center, float radius) const {
+        return distance_squared(center) <= radius * radius;
+    }
+};
+
+#endif
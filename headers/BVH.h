@@ -0,0 +1,44 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <vector>
+
+#include "AABB.h"
+#include "Frustum.h"
+#include "Object.h"
+
+// Bounding volume hierarchy over the world bounds of a set of objects, used to find the objects
+// inside the view frustum without testing each one.
+//
+// Nodes are stored depth first, so children always come after their parent and a refit is one
+// reverse pass over the array. update() refits when an object moved and rebuilds when objects
+// were added or removed.
+class BVH {
+private:
+	struct Node {
+		AABB bounds;
+		int first; // leaf: first of its objects, inner node: left child
+		int right; // inner node: right child
+		int count; // objects in a leaf, 0 for inner nodes
+	};
+
+	static const int MAX_LEAF_OBJECTS = 2;
+
+	std::vector<Node> nodes;
+	std::vector<Object*> objects; // leaf order
+	std::vector<unsigned int> versions; // transform version of each object when last fitted
+	const std::vector<Object*>* source = nullptr;
+
+	int build_node(int first, int count);
+	void refit();
+	void cull_node(int index, const Frustum& frustum, bool inside, std::vector<Object*>& visible) const;
+
+public:
+	// the hierarchy tracks this list, which has to outlive it
+	void build(const std::vector<Object*>& scene_objects);
+	void update();
+
+	// appends the objects whose bounds are at least partly inside the frustum
+	void cull(const Frustum& frustum, std::vector<Object*>& visible) const;
+};
+#endif
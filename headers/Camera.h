@@ -25,6 +25,11 @@ const float PITCH = 0.0f;
 const float SPEED = 2.5f;
 const float SENSITIVITY = 0.1f;
 const float ZOOM = 45.0f;
+const float NEAR_PLANE = 0.1f;
+const float FAR_PLANE = 100.0f;
+
+// Must match the binding of the "Camera" uniform block in the shaders
+const unsigned int CAMERA_BLOCK_BINDING = 1;
 
 
 // An abstract camera class that processes input and calculates the corresponding Euler Angles, Vectors and Matrices for use in OpenGL
@@ -33,14 +38,14 @@ class Camera
 public:
     static Camera* instance;
     // camera Attributes
-    glm::vec3 position;
-    glm::vec2 forbidden_directions;
-    glm::vec3 size;
+    glm::vec3 position; // simulated position, changed only by fixed timestep updates
+    glm::vec3 previous_position; // position before the last update
+    glm::vec3 render_position; // interpolated between the two for the current frame
+    glm::vec3 size; // of the collision capsule
     glm::vec3 front;
     glm::vec3 up;
     glm::vec3 right;
     glm::vec3 world_up;
-    Object* colliding;
     float y;
     // euler Angles
     float yaw;
@@ -49,6 +54,10 @@ public:
     float movement_speed;
     float mouse_sensitivity;
     float zoom;
+    // matrices of the current frame, computed once by upload_uniforms()
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 view_projection;
 
     // constructor with vectors
     Camera(glm::vec3 position = glm::vec3(0.0f, 1.8f, 3.0f),
@@ -63,8 +72,9 @@ public:
             instance = this;
         }
         else throw std::runtime_error("Instance of camera already exists!");
-        this->colliding = nullptr;
         this->position = position;
+        this->previous_position = position;
+        this->render_position = position;
         this->y = position.y;
         this->world_up = up;
         this->yaw = yaw;
@@ -91,6 +101,8 @@ public:
         }
         else throw std::runtime_error("Instance of camera already exists!");
         this->position = glm::vec3(posX, posY, posZ);
+        this->previous_position = position;
+        this->render_position = position;
         this->world_up = glm::vec3(upX, upY, upZ);
         this->yaw = yaw;
         this->pitch = pitch;
@@ -100,12 +112,23 @@ public:
     // returns the view matrix calculated using Euler Angles and the LookAt Matrix
     glm::mat4 get_view_matrix()
     {
-        return glm::lookAt(position, position + front, up);
+        return glm::lookAt(render_position, render_position + front, up);
+    }
+
+    // call at the start of every fixed timestep update, before moving the camera
+    void begin_update()
+    {
+        previous_position = position;
+    }
+
+    // alpha is the fraction of a timestep that passed since the last update
+    void interpolate(float alpha)
+    {
+        render_position = glm::mix(previous_position, position, alpha);
     }
 
     void on_keyboard_input(Camera_Movement direction, float delta_time, bool increased_movement_speed)
     {
-        glm::vec3 old_position = position;
         float velocity = movement_speed * delta_time * (increased_movement_speed ? 2.0f : 1.0f);
         if (direction == FORWARD)
             position += front * velocity;
@@ -116,38 +139,6 @@ public:
         if (direction == RIGHT)
             position += right * velocity;
 
-        if (colliding) {
-            if ((forbidden_directions.x < 0 && old_position.x > position.x)
-                || (forbidden_directions.x > 0 && old_position.x < position.x)) {
-                position.x = old_position.x;
-            }
-            if ((forbidden_directions.y < 0 && old_position.z > position.z)
-                || (forbidden_directions.y > 0 && old_position.z < position.z)) {
-                position.z = old_position.z;
-            }
-
-            if (!check_collision(colliding)) {
-                colliding = nullptr;
-            }
-        }
-        else {
-            float x = 0.0f;
-            if (old_position.x < position.x) {
-                x = 1.0f;
-            }
-            else if (old_position.x > position.x) {
-                x = -1.0f;
-            }
-            float z = 0.0f;
-            if (old_position.z < position.z) {
-                z = 1.0f;
-            }
-            else if (old_position.z > position.z) {
-                z = -1.0f;
-            }
-
-            forbidden_directions = glm::vec2(x, z);
-        }
         position.y = y;
     }
 
@@ -180,9 +171,13 @@ public:
             zoom = 45.0f;
     }
 
-    bool check_collision(Object* other) const;
+    // computes view, projection and view-projection for this frame and uploads them together with
+    // the camera position to the "Camera" uniform block shared by every shader
+    void upload_uniforms(float aspect_ratio);
 
 private:
+    unsigned int ubo = 0;
+
     void update_camera_vectors()
     {
         glm::vec3 new_front;
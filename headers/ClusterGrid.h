@@ -0,0 +1,55 @@
+#ifndef CLUSTER_GRID_H
+#define CLUSTER_GRID_H
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "AABB.h"
+
+// Must match the CLUSTER_* defines, the sampler units and the "Clusters" block binding in texture_shader.fs
+const int CLUSTER_X = 16;
+const int CLUSTER_Y = 9;
+const int CLUSTER_Z = 24;
+const int CLUSTER_COUNT = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+const unsigned int CLUSTERS_BLOCK_BINDING = 2;
+const int CLUSTER_GRID_TEXTURE_UNIT = 2;
+const int CLUSTER_INDEX_TEXTURE_UNIT = 3;
+
+// Splits the view frustum into CLUSTER_X * CLUSTER_Y screen tiles and CLUSTER_Z exponential depth
+// slices and lists, for every cluster, the point lights whose attenuation radius reaches into it.
+// A fragment only shades the lights of its own cluster.
+//
+// The lists go to two texture buffers: the grid holds (offset, count) per cluster, the offsets point
+// into one array of 16 bit indices into PointLightManager's light buffer.
+class ClusterGrid {
+private:
+	static glm::mat4 bounds_projection;
+	static std::vector<AABB> bounds; // view space, recomputed when the projection changes
+	static std::vector<unsigned int> cluster_ranges; // offset, count
+	static std::vector<unsigned short> light_indices;
+	static std::vector<std::pair<int, unsigned short>> hits; // cluster, light
+	static float near_plane;
+	static float far_plane;
+
+	static unsigned int ubo;
+	static unsigned int grid_buffer;
+	static unsigned int grid_texture;
+	static unsigned int index_buffer;
+	static unsigned int index_texture;
+	static size_t index_capacity;
+
+	static void create_buffers();
+	static void compute_bounds(const glm::mat4& projection);
+	static int get_slice(float depth);
+	static void bin_lights(const glm::mat4& view, const glm::mat4& projection);
+	static void upload(int viewport_width, int viewport_height);
+public:
+	// bins the lights that are on for this frame's camera, call after the camera matrices were updated
+	static void update(const glm::mat4& view, const glm::mat4& projection, int viewport_width, int viewport_height);
+
+	static size_t get_light_index_count() {
+		return light_indices.size();
+	}
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef COOKED_TEXTURE_H
+#define COOKED_TEXTURE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Container written by asset_cook and read by TextureCache: the complete mip chain of an image,
+// block compressed, plus the same chain as RGBA8 for drivers without S3TC. Rows run bottom to top
+// like OpenGL expects, the mips are uploaded from the file as they are.
+//
+//   CookedTextureHeader, CookedMip[mip_count], mip data
+//
+// Offsets count from the start of the file, the byte order is that of the machine that cooked it.
+const char COOKED_TEXTURE_MAGIC[4] = {'C', 'T', 'E', 'X'};
+const uint32_t COOKED_TEXTURE_VERSION = 1;
+
+enum CookedTextureFormat : uint32_t {
+    COOKED_BC1 = 1, // opaque images, 8 bytes per 4x4 block
+    COOKED_BC3 = 2  // images with alpha, 16 bytes per 4x4 block
+};
+
+struct CookedTextureHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mip_count;
+};
+
+struct CookedMip {
+    uint32_t width;
+    uint32_t height;
+    uint32_t compressed_offset;
+    uint32_t compressed_size;
+    uint32_t fallback_offset;
+    uint32_t fallback_size;
+};
+
+// "../resources/floor.jpg" is cooked to "../resources/floor.ctex"
+inline std::string get_cooked_texture_path(const std::string& source_path) {
+    size_t dot = source_path.find_last_of('.');
+    size_t slash = source_path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return source_path + ".ctex";
+    }
+    return source_path.substr(0, dot) + ".ctex";
+}
+
+// checks that the header and every mip lie inside the file
+inline bool is_valid_cooked_texture(const char* data, size_t size) {
+    if (size < sizeof(CookedTextureHeader) || std::memcmp(data, COOKED_TEXTURE_MAGIC, sizeof(COOKED_TEXTURE_MAGIC)) != 0) {
+        return false;
+    }
+    const auto* header = reinterpret_cast<const CookedTextureHeader*>(data);
+    if (header->version != COOKED_TEXTURE_VERSION || header->mip_count == 0 || header->mip_count > 32
+        || (header->format != COOKED_BC1 && header->format != COOKED_BC3)
+        || size < sizeof(CookedTextureHeader) + header->mip_count * sizeof(CookedMip)) {
+        return false;
+    }
+    const auto* mips = reinterpret_cast<const CookedMip*>(data + sizeof(CookedTextureHeader));
+    for (uint32_t i = 0; i < header->mip_count; i++) {
+        if ((uint64_t) mips[i].compressed_offset + mips[i].compressed_size > size
+            || (uint64_t) mips[i].fallback_offset + mips[i].fallback_size > size
+            || mips[i].fallback_size != (uint64_t) mips[i].width * mips[i].height * 4) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif
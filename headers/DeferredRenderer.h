@@ -0,0 +1,47 @@
+#ifndef DEFERRED_RENDERER_H
+#define DEFERRED_RENDERER_H
+
+#include <vector>
+
+#include "Shader.h"
+#include "RenderQueue.h"
+
+// Must match the sampler units set on the "deferred_lighting" shader
+const int GBUFFER_ALBEDO_TEXTURE_UNIT = 4;
+const int GBUFFER_NORMAL_TEXTURE_UNIT = 5;
+const int GBUFFER_DEPTH_TEXTURE_UNIT = 6;
+
+// Alternative to shading in texture_shader.fs. The geometry pass writes albedo, normal and depth of
+// the closest surface into a G-buffer, the lighting pass then shades every covered pixel once with
+// the lights of its cluster, so the lighting cost no longer grows with overdraw.
+//
+// The lighting pass writes the scene depth into the target as well, forward passes drawn after it
+// (the lamps) depth test as usual.
+class DeferredRenderer {
+private:
+	static unsigned int fbo;
+	static unsigned int albedo_texture;
+	static unsigned int normal_texture;
+	static unsigned int depth_texture;
+	static unsigned int empty_vao;
+	static int width;
+	static int height;
+	static int target_fbo;
+	static const Shader* geometry_shader;
+	static const Shader* lighting_shader;
+
+	static bool create_gbuffer(int width, int height);
+	static void destroy_gbuffer();
+public:
+	// geometry_shader replaces the shader of every object in the geometry pass
+	static void init(const Shader* geometry_shader, const Shader* lighting_shader);
+
+	// renders the queue into the G-buffer, resized to the viewport when needed
+	static void geometry_pass(const std::vector<DrawItem>& items, int viewport_width, int viewport_height);
+	// shades the G-buffer into the framebuffer that was bound before the geometry pass
+	static void lighting_pass();
+
+	static void free();
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include "AABB.h"
+
+enum FrustumTest {
+    OUTSIDE,
+    INTERSECTING,
+    INSIDE
+};
+
+// The six planes of a view-projection matrix, normals pointing inwards
+struct Frustum {
+    glm::vec4 planes[6];
+
+    // Gribb/Hartmann: every plane is the sum or difference of the last row and one other row
+    static Frustum from_matrix(const glm::mat4& view_projection) {
+        glm::vec4 rows[4];
+        for (int i = 0; i < 4; i++) {
+            rows[i] = glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+        }
+
+        Frustum frustum;
+        for (int i = 0; i < 3; i++) {
+            frustum.planes[i * 2] = rows[3] + rows[i];
+            frustum.planes[i * 2 + 1] = rows[3] - rows[i];
+        }
+        for (glm::vec4& plane : frustum.planes) {
+            plane /= glm::length(glm::vec3(plane));
+        }
+        return frustum;
+    }
+
+    FrustumTest test(const AABB& box) const {
+        FrustumTest result = INSIDE;
+        for (const glm::vec4& plane : planes) {
+            glm::vec3 normal(plane);
+            // the corners furthest along and against the normal
+            glm::vec3 positive = glm::mix(box.min, box.max, glm::step(0.0f, normal));
+            glm::vec3 negative = glm::mix(box.max, box.min, glm::step(0.0f, normal));
+            if (glm::dot(normal, positive) + plane.w < 0.0f) {
+                return OUTSIDE;
+            }
+            if (glm::dot(normal, negative) + plane.w < 0.0f) {
+                result = INTERSECTING;
+            }
+        }
+        return result;
+    }
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include "external/glfw-3.1.2/deps/glad/glad.h"
+
+// The bundled glad loader stops at the GL 3.2 core profile.
+// Entry points from GL 3.3 that the renderer needs are declared and loaded here, in the same style.
+
+typedef void (APIENTRYP PFNGLVERTEXATTRIBDIVISORPROC)(GLuint index, GLuint divisor);
+extern PFNGLVERTEXATTRIBDIVISORPROC ext_glVertexAttribDivisor;
+#define glVertexAttribDivisor ext_glVertexAttribDivisor
+
+// ARB_timer_query, optional: the profiler only measures GPU time when it was loaded
+#define GL_TIME_ELAPSED 0x88BF
+typedef void (APIENTRYP PFNGLGETQUERYOBJECTUI64VPROC)(GLuint id, GLenum pname, GLuint64* params);
+extern PFNGLGETQUERYOBJECTUI64VPROC ext_glGetQueryObjectui64v;
+#define glGetQueryObjectui64v ext_glGetQueryObjectui64v
+
+// EXT_texture_compression_s3tc, optional: cooked textures fall back to their RGBA8 mips without it
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+extern bool ext_texture_compression_s3tc;
+
+// ARB_multi_draw_indirect, optional: InstancedRenderer submits one instanced draw per group without it.
+// Also needs ARB_base_instance (core in 4.2), the commands select their instances by base_instance
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect,
+                                                           GLsizei drawcount, GLsizei stride);
+extern PFNGLMULTIDRAWELEMENTSINDIRECTPROC ext_glMultiDrawElementsIndirect;
+#define glMultiDrawElementsIndirect ext_glMultiDrawElementsIndirect
+extern bool ext_multi_draw_indirect;
+
+// ARB_copy_image (core in 4.3), optional: StaticBatcher copies through a pixel buffer without it
+typedef void (APIENTRYP PFNGLCOPYIMAGESUBDATAPROC)(GLuint srcName, GLenum srcTarget, GLint srcLevel,
+                                                   GLint srcX, GLint srcY, GLint srcZ,
+                                                   GLuint dstName, GLenum dstTarget, GLint dstLevel,
+                                                   GLint dstX, GLint dstY, GLint dstZ,
+                                                   GLsizei srcWidth, GLsizei srcHeight, GLsizei srcDepth);
+extern PFNGLCOPYIMAGESUBDATAPROC ext_glCopyImageSubData;
+#define glCopyImageSubData ext_glCopyImageSubData
+extern bool ext_copy_image;
+
+// returns false if a required entry point is missing
+bool load_gl_extensions(GLADloadproc load);
+
+#endif
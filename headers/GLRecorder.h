@@ -0,0 +1,42 @@
+#ifndef GL_RECORDER_H
+#define GL_RECORDER_H
+
+#include <cstddef>
+
+struct GLFrameStats {
+    int total_calls;
+    int draw_calls;
+    int program_binds;
+    int texture_binds;
+    int vertex_array_binds;
+    int buffer_binds;
+    int framebuffer_binds;
+    int uniform_uploads;
+    size_t bytes_uploaded; // buffer and texture data
+};
+
+// Swappable GL dispatch layer. glad (and GLExtensions) call OpenGL through global function pointers,
+// so recording is a matter of swapping those pointers for wrappers that count the call before
+// forwarding it.
+//
+// FORWARD wraps the functions of a live context. NULL_DRIVER needs no context at all: calls are
+// only counted, object names are made up and compile/link/framebuffer checks succeed, which lets
+// the renderer run on machines without any GPU.
+//
+// Every GL function the renderer calls has to be listed in GLRecorder.cpp, an unlisted one stays
+// a null pointer in NULL_DRIVER mode.
+class GLRecorder {
+public:
+	enum Mode {
+		FORWARD,
+		NULL_DRIVER
+	};
+
+	static void install(Mode mode);
+	static void uninstall();
+
+	// resets the counters, call at the start of every frame
+	static void begin_frame();
+	static const GLFrameStats& get_frame_stats();
+};
+#endif
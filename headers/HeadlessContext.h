@@ -0,0 +1,23 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+#include "external/glfw-3.1.2/deps/glad/glad.h"
+
+// Offscreen OpenGL 3.3 core context without a window, for benchmarks on machines with no display.
+// The context is created through EGL on a pbuffer (the Mesa surfaceless platform when available,
+// so llvmpipe works without a GPU) and frames are rendered into a framebuffer object.
+// Only available when the build found EGL (HAVE_EGL).
+class HeadlessContext {
+private:
+	static unsigned int fbo;
+	static unsigned int color_buffer;
+	static unsigned int depth_buffer;
+public:
+	static bool create(int width, int height);
+	// creates the framebuffer object frames are drawn to, needs loaded GL function pointers
+	static bool create_framebuffer(int width, int height);
+	static void destroy();
+
+	static GLADloadproc get_proc_address();
+};
+#endif
@@ -0,0 +1,77 @@
+#ifndef INSTANCED_RENDERER_H
+#define INSTANCED_RENDERER_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "Object.h"
+#include "RenderQueue.h"
+#include "PointLightManager.h"
+
+// Per-instance vertex attributes, must match the layout locations in texture_shader.vs
+const int INSTANCE_MODEL_LOCATION = 3;  // mat4, locations 3-6
+const int INSTANCE_NORMAL_LOCATION = 7; // mat3, locations 7-9
+const int INSTANCE_LIGHTS_LOCATION = 10; // 2 ivec4, locations 10-11
+
+// layout read by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand {
+    unsigned int count;
+    unsigned int instance_count;
+    unsigned int first_index;
+    int base_vertex;
+    unsigned int base_instance;
+};
+
+struct InstanceData {
+    glm::mat4 model;
+    glm::mat3 normal;
+    int lights[MAX_OBJECT_LIGHTS]; // -1 terminated, see set_object_lights()
+};
+
+// Submits a sorted render queue. Consecutive items that share mesh, shader and texture form a group
+// that is drawn instanced, and program, texture and vertex array are only bound when they differ
+// from the previous group. The transforms of all instances of a frame are written into one
+// instance buffer. A shader_override draws every item with that shader instead of its own.
+//
+// With ARB_multi_draw_indirect every group becomes a command in an indirect buffer instead, and
+// consecutive groups with the same program and texture go out as one glMultiDrawElementsIndirect.
+// The command's base instance points the instance attributes at the group's instances. Without
+// the extension (the core 3.3 fallback), or when disabled, every group is its own draw.
+//
+// With object lights enabled, every instance also carries the lights that reach its bounds, which
+// texture_shader.fs shades instead of the lights of the fragment's cluster. The list of an object is
+// kept until it moves or the lights change.
+class InstancedRenderer {
+private:
+	static unsigned int instance_vbo;
+	static size_t instance_capacity;
+	static std::vector<InstanceData> instances;
+	static bool object_lights;
+
+	struct CachedLights {
+		int lights[MAX_OBJECT_LIGHTS];
+		unsigned int transform_version;
+		unsigned int lights_version; // PointLightManager::get_version()
+	};
+	// objects live for the whole run, so their addresses are never reused for another object
+	static std::unordered_map<const Object*, CachedLights> light_cache;
+	static unsigned int indirect_buffer;
+	static size_t indirect_capacity;
+	static std::vector<DrawElementsIndirectCommand> commands;
+	static bool multi_draw_indirect;
+
+	static void bind_instance_attributes(size_t first_instance);
+	static void draw_instanced(const std::vector<DrawItem>& items, const Shader* shader_override);
+	static void draw_indirect(const std::vector<DrawItem>& items, const Shader* shader_override);
+public:
+	static void set_object_lights(bool enabled) {
+		object_lights = enabled;
+	}
+	// only has an effect when the driver has ARB_multi_draw_indirect
+	static void set_multi_draw_indirect(bool enabled) {
+		multi_draw_indirect = enabled;
+	}
+
+	static void draw(const std::vector<DrawItem>& items, const Shader* shader_override = nullptr);
+};
+#endif
@@ -4,12 +4,14 @@
 #include "stb_image.h"
 
 #include "Shader.h"
+#include "MeshRegistry.h"
 
 class Light {
 private:
-	unsigned int VBO{}, VAO{}, EBO{};
+	Mesh* mesh;
 	unsigned int texture{};
 	Shader* shader;
+	int model_location;
 	float rotate_angle;
 
 public:
@@ -26,6 +28,11 @@ public:
           float rotate_angle,
           glm::vec3 translate_vec);
 
+	glm::mat4 get_model_matrix() const;
+	// world space box around the lamp mesh
+	AABB get_bounds() const;
+
 	void draw();
+	void free();
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef MESH_REGISTRY_H
+#define MESH_REGISTRY_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AABB.h"
+
+// Vertex layout shared by every mesh: position (3), normal (3), texture coordinates (2)
+const int MESH_VERTEX_STRIDE = 8;
+// Per-vertex material layer, kept in a buffer of its own so the stride above stays the same
+const int MESH_MATERIAL_LOCATION = 12;
+const short NO_MATERIAL = -1; // the vertex samples its object's own texture
+
+// A range of the shared geometry buffers. Every mesh is indexed, its indices count from base_vertex
+struct Mesh {
+    std::string name;
+    unsigned int id; // orders draws by mesh, unique among the live meshes
+    unsigned int VAO; // the shared vertex array
+    int base_vertex;
+    int first_index;
+    int vertex_count;
+    int index_count;
+    int references;
+    AABB bounds; // model space
+    // what was uploaded, kept for load time passes over the geometry (StaticBatcher) until
+    // MeshRegistry::discard_cpu_copies()
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+};
+
+// Uploads each mesh once and hands out shared, reference counted handles to it.
+//
+// All meshes live in one vertex buffer, its parallel material buffer and one index buffer behind
+// one vertex array, so draws of different meshes need no vertex array switch and can go into the
+// same multi draw. The buffers double when they run out of space. The space of a released mesh is
+// not reused, the buffers are deleted once the last mesh is released.
+class MeshRegistry {
+private:
+	static std::unordered_map<std::string, Mesh*> meshes;
+	static unsigned int next_id;
+	static unsigned int vertex_array;
+	static unsigned int vertex_buffer;
+	static unsigned int index_buffer;
+	static unsigned int material_buffer;
+	static int vertex_capacity;
+	static int vertices_used;
+	static int index_capacity;
+	static int indices_used;
+
+	// grows the buffers until they have room for that many more vertices and indices
+	static void reserve(int vertex_count, int index_count);
+public:
+	// vertices, indices and materials are only read the first time a name is acquired. Without
+	// indices every three vertices are a triangle, without materials every vertex has NO_MATERIAL
+	static Mesh* acquire(const std::string& name, const float* vertices, int vertex_count,
+	                     const unsigned int* indices = nullptr, int index_count = 0,
+	                     const short* materials = nullptr);
+	// another reference to the mesh registered under name, nullptr if there is none
+	static Mesh* acquire_existing(const std::string& name);
+	// unit cube centered on the origin, 24 vertices and 36 indices
+	static Mesh* acquire_cube();
+	static void release(Mesh* mesh);
+	// frees the vertices and indices every mesh keeps, call once the load time passes are done
+	static void discard_cpu_copies();
+};
+#endif
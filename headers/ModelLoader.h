@@ -0,0 +1,16 @@
+#ifndef MODEL_LOADER_H
+#define MODEL_LOADER_H
+
+#include <string>
+
+#include "MeshRegistry.h"
+
+// Imports furniture models (OBJ, FBX, DAE and the other formats Assimp reads) into indexed meshes.
+// The import triangulates, welds identical vertices and reorders the triangles of every part for
+// the post-transform vertex cache. The parts are merged into one mesh, registered under the path.
+class ModelLoader {
+public:
+	// nullptr if the file could not be imported or holds no triangles
+	static Mesh* acquire(const std::string& path);
+};
+#endif
@@ -2,25 +2,34 @@
 #define OBJECT_H
 
 #include "Shader.h"
-#include "stb_image.h"
+#include "MeshRegistry.h"
+#include "TextureCache.h"
 
 class Object {
 private:
-	unsigned int VBO, VAO, EBO;
-	unsigned int texture;
+	Mesh* mesh;
+	Texture* texture;
 	Shader* shader;
 
-	const char* texture_name;
+	std::string texture_name;
+	unsigned int material_array;
+	bool static_object;
 
+	glm::vec3 scale_vec;
+	glm::vec3 rotate_vec;
 	float rotate_angle;
+	glm::vec3 translate_vec;
 
-	void load_texture();
-	void light();
+	// recomputed on first use after one of the transform setters ran
+	unsigned int transform_version;
+	mutable bool transform_dirty;
+	mutable glm::mat4 model_matrix;
+	mutable glm::mat3 normal_matrix;
+	mutable AABB bounds;
+
+	void update_transform() const;
 
 public:
-	glm::vec3 scale_vec;
-	glm::vec3 rotate_vec;
-	glm::vec3 translate_vec;
 	std::string name;
 
 	Object(std::string name,
@@ -28,9 +37,39 @@ public:
            glm::vec3 rotate_vec,
            float rotate_angle,
            glm::vec3 translate_vec,
-           const char* texture_name);
+           const char* texture_name,
+           const char* model_path = nullptr); // the unit cube without a model
+	// an untransformed object drawing mesh, takes over the caller's reference to it
+	Object(std::string name, Mesh* mesh, const std::string& texture_name);
+
+	Shader* get_shader() const { return shader; }
+	const Mesh* get_mesh() const { return mesh; }
+	unsigned int get_texture() const { return texture->ID; }
+	const std::string& get_texture_name() const { return texture_name; }
+	// the texture array a StaticBatcher batch samples through its per-vertex layers, 0 for none
+	unsigned int get_material_array() const { return material_array; }
+	void set_material_array(unsigned int array) { material_array = array; }
+
+	// static objects are never moved after loading, which lets StaticBatcher merge them
+	bool is_static() const { return static_object; }
+	void set_static(bool value) { static_object = value; }
+
+	const glm::vec3& get_scale_vec() const { return scale_vec; }
+	const glm::vec3& get_rotate_vec() const { return rotate_vec; }
+	float get_rotate_angle() const { return rotate_angle; }
+	const glm::vec3& get_translate_vec() const { return translate_vec; }
+
+	void set_scale_vec(const glm::vec3& scale);
+	void set_rotation(float angle, const glm::vec3& axis);
+	void set_translate_vec(const glm::vec3& translation);
+
+	const glm::mat4& get_model_matrix() const;
+	const glm::mat3& get_normal_matrix() const;
+	// world space box around the mesh
+	const AABB& get_bounds() const;
+	// changes whenever one of the transform setters ran
+	unsigned int get_transform_version() const { return transform_version; }
 
-	void draw();
 	void free();
 };
-#endif
\ No newline at end of file
+#endif
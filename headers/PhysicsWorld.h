@@ -0,0 +1,58 @@
+#ifndef PHYSICS_WORLD_H
+#define PHYSICS_WORLD_H
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include <btBulletCollisionCommon.h>
+#include <BulletCollision/CollisionDispatch/btGhostObject.h>
+
+#include "Object.h"
+
+// Bullet collision world of the room. Every object is a static box with the object's full transform,
+// rotation included, in a btDbvtBroadphase. The camera moves through it as a kinematic capsule that
+// slides along whatever it runs into.
+class PhysicsWorld {
+private:
+	struct Body {
+		Object* object;
+		unsigned int version; // transform version the body was placed with
+		btCollisionObject* collision_object;
+		btBoxShape* shape;
+	};
+
+	static btDefaultCollisionConfiguration* configuration;
+	static btCollisionDispatcher* dispatcher;
+	static btDbvtBroadphase* broadphase;
+	static btGhostPairCallback* ghost_pair_callback;
+	static btCollisionWorld* world;
+
+	static std::vector<Body> bodies;
+	static const std::vector<Object*>* source;
+
+	static btCapsuleShape* character_shape;
+	static btPairCachingGhostObject* character;
+
+	static void place_body(Body& body);
+	static void add_body(Body& body);
+	static void clear_bodies();
+	static bool recover_from_penetration();
+	static btVector3 sweep(const btVector3& from, const btVector3& to);
+public:
+	static void init();
+
+	// adds a static box for every object, the list has to outlive the world
+	static void build(const std::vector<Object*>& objects);
+	// moves the boxes of objects whose transform changed, rebuilds if objects were added or removed
+	static void update();
+
+	// capsule around the camera, size is the camera's box (width, height, depth)
+	static void create_character(const glm::vec3& size, const glm::vec3& position);
+	// moves the character from one position towards another, sliding along the surfaces it hits.
+	// Returns where it ended up
+	static glm::vec3 move_character(const glm::vec3& from, const glm::vec3& to);
+
+	static void free();
+};
+
+#endif
@@ -7,6 +7,19 @@
 #include <glm/gtx/matrix_transform_2d.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "AABB.h"
+
+// Must match the binding of the "Lights" block and the unit of pointLightData in texture_shader.fs
+const unsigned int LIGHTS_BLOCK_BINDING = 0;
+const int LIGHT_DATA_TEXTURE_UNIT = 1;
+// 4 texels per light in the texture buffer, GL guarantees at least 65536 texels
+const int MAX_POINT_LIGHTS = 16384;
+// by default a light stops reaching a surface once its brightest channel is attenuated below one 8 bit step
+const float DEFAULT_LIGHT_CUTOFF = 1.0f / 256.0f;
+const float MAX_LIGHT_RADIUS = 100.0f;
+// Must match the two ivec4 light attributes in texture_shader.vs
+const int MAX_OBJECT_LIGHTS = 8;
+
 struct PointLight {
     std::string name;
 	bool on;
@@ -19,15 +32,37 @@ struct PointLight {
 	float quadratic;
 };
 
+struct DirLight {
+    glm::vec3 direction;
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+};
+
+// Owns every light in the scene. The directional light goes to a std140 uniform buffer shared by all
+// shaders, point lights to a texture buffer that ClusterGrid indexes into.
+// Lights are public structs, so whoever changes one has to call mark_dirty() for it to be re-uploaded.
 class PointLightManager {
 private:
 	static std::vector<PointLight*> point_lights;
+	static DirLight directional_light;
+	static unsigned int ubo;
+	static unsigned int light_buffer;
+	static unsigned int light_texture;
+	static float light_cutoff;
+	static std::vector<float> light_radii; // of every light, computed by upload()
+	static unsigned int version;
+	static bool dirty;
+
+	// distance at which the attenuation of the light drops below the cutoff
+	static float get_light_radius(const PointLight& light);
 public:
 	static void add_point_light(PointLight* point_light) {
 		point_lights.push_back(point_light);
+		dirty = true;
 	}
 
-	static std::vector<PointLight*> get_point_lights() {
+	static const std::vector<PointLight*>& get_point_lights() {
 		return point_lights;
 	}
 
@@ -39,6 +74,41 @@ public:
         }
         return nullptr;
     }
+
+	static void set_directional_light(const DirLight& light) {
+		directional_light = light;
+		dirty = true;
+	}
+
+	static void mark_dirty() {
+		dirty = true;
+	}
+
+	// lower cutoffs give larger radii, more light reaches further at a higher shading cost
+	static void set_light_cutoff(float cutoff) {
+		light_cutoff = cutoff;
+		dirty = true;
+	}
+
+	// radius of every light as of the last upload(), the distance at which its attenuation drops
+	// below the cutoff. Indexed like get_point_lights()
+	static const std::vector<float>& get_light_radii() {
+		return light_radii;
+	}
+
+	// Writes the indices of up to MAX_OBJECT_LIGHTS lights that are on and reach into bounds,
+	// strongest at the closest point first, and fills the rest with -1. Returns how many were found.
+	// Uses the radii of the last upload()
+	static int find_relevant_lights(const AABB& bounds, int* indices);
+
+	// changes whenever upload() rewrote the lights, results of find_relevant_lights() from an
+	// older version may be stale
+	static unsigned int get_version() {
+		return version;
+	}
+
+	// Called once per frame; rewrites the buffers only if a light changed since the last upload
+	static void upload();
 };
 
-#endif
\ No newline at end of file
+#endif
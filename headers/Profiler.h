@@ -0,0 +1,63 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+struct ProfileEvent {
+    const char* name;
+    int frame;
+    int depth;
+    double cpu_start;    // microseconds since the capture started
+    double cpu_duration; // microseconds
+    double gpu_duration; // microseconds, -1 while the query is pending or when there is none
+    unsigned int query;
+};
+
+// Scoped CPU timing plus GPU timing through GL_TIME_ELAPSED queries for a range of frames.
+//
+// Time elapsed queries can't nest, so only the outermost scopes of a frame get one. Results are
+// polled at the start of every frame and never waited for, the trace is written once the last
+// frame of the range has all of its results.
+class Profiler {
+private:
+	static std::vector<ProfileEvent> events;
+	static std::vector<int> open_scopes; // indices into events
+	static std::vector<unsigned int> free_queries;
+	static size_t first_pending;         // events before this index are resolved
+	static std::chrono::steady_clock::time_point epoch;
+	static std::string trace_path;
+	static int first_frame;
+	static int last_frame;
+	static int frame;
+	static bool written;
+
+	static bool capturing();
+	static double now();
+	static void resolve_queries();
+	static void write_trace();
+public:
+	// captures frames [first, last], counted from the first begin_frame(), into a Chrome trace file
+	static void capture(int first, int last, const std::string& path);
+
+	static void begin_frame();
+	static void end_frame();
+
+	static void begin_scope(const char* name);
+	static void end_scope();
+
+	// waits for outstanding queries and writes the trace if the range was cut short
+	static void shutdown();
+};
+
+// profiles the enclosing block
+class ProfileScope {
+public:
+	explicit ProfileScope(const char* name) { Profiler::begin_scope(name); }
+	~ProfileScope() { Profiler::end_scope(); }
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#endif
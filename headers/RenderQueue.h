@@ -0,0 +1,38 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Object.h"
+
+struct DrawItem {
+    uint64_t key;
+    Object* object;
+};
+
+// Collects the draws of a frame and orders them by state so that consecutive items share
+// shader, texture and mesh. The 64-bit sort key is, from the most significant bits:
+//   shader (8) | texture (16) | mesh (16) | view depth (24)
+// GL names and mesh ids are truncated to their field, submission still compares the real state.
+class RenderQueue {
+private:
+	std::vector<DrawItem> items;
+	std::vector<DrawItem> scratch;
+	float far_plane;
+
+public:
+	explicit RenderQueue(float far_plane = 100.0f) : far_plane(far_plane) {}
+
+	static uint64_t make_key(unsigned int shader, unsigned int texture, unsigned int mesh, float depth);
+
+	void clear() { items.clear(); }
+	void push(Object* object, const glm::mat4& view);
+	// LSD radix sort, 8 bits per pass, passes where every key has the same byte are skipped
+	void sort();
+
+	const std::vector<DrawItem>& get_items() const { return items; }
+};
+#endif
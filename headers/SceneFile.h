@@ -0,0 +1,73 @@
+#ifndef SCENE_FILE_H
+#define SCENE_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Object.h"
+#include "Light.h"
+#include "PointLightManager.h"
+
+// Scene layouts, loaded at startup instead of being compiled in.
+//
+// The text form is for authoring, one entry per line, '#' starts a comment:
+//   directional <direction xyz> <ambient rgb> <diffuse rgb> <specular rgb>
+//   object <name> <texture path> <scale xyz> <rotation axis xyz> <angle> <translation xyz>
+//   model <name> <model path> <texture path> <scale xyz> <rotation axis xyz> <angle> <translation xyz>
+//   light <name> <scale xyz> <rotation axis xyz> <ambient rgb> <angle> <translation xyz>
+// An object or model entry prefixed with "static" never moves, see StaticBatcher.
+//
+// compile() turns it into the binary form: a header, fixed size object and light records and a
+// table of the names and paths they point into. Loading maps the file and reads the records in
+// place. The binary form uses the byte order of the machine that compiled it.
+class SceneFile {
+public:
+	struct ObjectRecord {
+		uint32_t name; // offsets into the string table
+		uint32_t texture;
+		uint32_t model; // NO_MODEL for the unit cube
+		glm::vec3 scale;
+		glm::vec3 rotation_axis;
+		float rotation_angle;
+		glm::vec3 translation;
+		uint32_t flags;
+	};
+
+	static const uint32_t NO_MODEL = 0xFFFFFFFF;
+	static const uint32_t STATIC_OBJECT = 1;
+
+	struct LightRecord {
+		uint32_t name;
+		glm::vec3 scale;
+		glm::vec3 rotation_axis;
+		glm::vec3 ambient;
+		float rotation_angle;
+		glm::vec3 translation;
+	};
+
+private:
+	// the parsed text form, laid out like the binary one
+	struct Scene {
+		std::vector<ObjectRecord> objects;
+		std::vector<LightRecord> lights;
+		bool has_directional_light = false;
+		DirLight directional_light = {};
+		std::string strings;
+	};
+
+	static bool parse_text(const std::string& path, Scene& scene);
+	static bool instantiate(const ObjectRecord* objects, uint32_t object_count,
+	                        const LightRecord* lights, uint32_t light_count,
+	                        const DirLight* directional_light,
+	                        const char* strings, size_t strings_size,
+	                        std::vector<Object*>& room_objects, std::vector<Light*>& light_objects);
+
+public:
+	// creates the objects and lights of a text or binary scene file, told apart by the binary's magic
+	static bool load(const std::string& path, std::vector<Object*>& objects, std::vector<Light*>& lights);
+
+	// writes the binary form of a text scene file
+	static bool compile(const std::string& text_path, const std::string& binary_path);
+};
+#endif
@@ -10,6 +10,8 @@
 #include <glm/gtx/matrix_transform_2d.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <utility>
+#include <unordered_map>
+#include <vector>
 
 class Shader
 {
@@ -20,10 +22,13 @@ public:
     Shader(Shader* that) {
         this->ID = that->ID;
         this->name = that->name;
+        this->uniforms = that->uniforms;
     }
-    // constructor generates the shader on the fly
+    // constructor generates the shader on the fly. fragment_library_path, if given, names code shared
+    // by several fragment shaders that is inserted right after the #version line of this one
     // ------------------------------------------------------------------------
-    Shader(std::string name, const char* vertex_path, const char* fragment_path)
+    Shader(std::string name, const char* vertex_path, const char* fragment_path,
+           const char* fragment_library_path = nullptr)
     {
         this->name = std::move(name);
         // 1. retrieve the vertex/fragment source code from filePath
@@ -49,6 +54,16 @@ public:
             // convert stream into string
             vertex_code = v_shader_stream.str();
             fragment_code = f_shader_stream.str();
+            if (fragment_library_path)
+            {
+                std::ifstream library_file;
+                library_file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+                library_file.open(fragment_library_path);
+                std::stringstream library_stream;
+                library_stream << library_file.rdbuf();
+                library_file.close();
+                fragment_code = insert_library(fragment_code, library_stream.str());
+            }
         }
         catch (std::ifstream::failure& e)
         {
@@ -74,6 +89,7 @@ public:
         glAttachShader(ID, fragment);
         glLinkProgram(ID);
         check_compile_errors(ID, "PROGRAM");
+        reflect_uniforms();
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
@@ -84,66 +100,170 @@ public:
     {
         glUseProgram(ID);
     }
+    // points the named uniform block at a buffer binding index, blocks the program doesn't use are skipped
+    // ------------------------------------------------------------------------
+    void bind_uniform_block(const std::string& block_name, unsigned int binding) const
+    {
+        unsigned int index = glGetUniformBlockIndex(ID, block_name.c_str());
+        if (index != GL_INVALID_INDEX) {
+            glUniformBlockBinding(ID, index, binding);
+        }
+    }
+    // returns the location cached at link time, -1 (ignored by glUniform*) if the uniform is not active
+    // ------------------------------------------------------------------------
+    int get_uniform_location(const std::string& name) const
+    {
+        auto it = uniforms.find(name);
+        return it != uniforms.end() ? it->second : -1;
+    }
     // utility uniform functions
     // ------------------------------------------------------------------------
     void setBool(const std::string& name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        setBool(get_uniform_location(name), value);
+    }
+    void setBool(int location, bool value) const
+    {
+        glUniform1i(location, (int)value);
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string& name, int value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        setInt(get_uniform_location(name), value);
+    }
+    void setInt(int location, int value) const
+    {
+        glUniform1i(location, value);
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string& name, float value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        setFloat(get_uniform_location(name), value);
+    }
+    void setFloat(int location, float value) const
+    {
+        glUniform1f(location, value);
     }
     // ------------------------------------------------------------------------
     void setVec2(const std::string& name, const glm::vec2& value) const
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setVec2(get_uniform_location(name), value);
+    }
+    void setVec2(int location, const glm::vec2& value) const
+    {
+        glUniform2fv(location, 1, &value[0]);
     }
     void setVec2(const std::string& name, float x, float y) const
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        glUniform2f(get_uniform_location(name), x, y);
     }
     // ------------------------------------------------------------------------
     void setVec3(const std::string& name, const glm::vec3& value) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setVec3(get_uniform_location(name), value);
+    }
+    void setVec3(int location, const glm::vec3& value) const
+    {
+        glUniform3fv(location, 1, &value[0]);
     }
     void setVec3(const std::string& name, float x, float y, float z) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        glUniform3f(get_uniform_location(name), x, y, z);
     }
     // ------------------------------------------------------------------------
     void setVec4(const std::string& name, const glm::vec4& value) const
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setVec4(get_uniform_location(name), value);
+    }
+    void setVec4(int location, const glm::vec4& value) const
+    {
+        glUniform4fv(location, 1, &value[0]);
     }
     void setVec4(const std::string& name, float x, float y, float z, float w)
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        glUniform4f(get_uniform_location(name), x, y, z, w);
     }
     // ------------------------------------------------------------------------
     void setMat2(const std::string& name, const glm::mat2& mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat2(get_uniform_location(name), mat);
+    }
+    void setMat2(int location, const glm::mat2& mat) const
+    {
+        glUniformMatrix2fv(location, 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat3(const std::string& name, const glm::mat3& mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat3(get_uniform_location(name), mat);
+    }
+    void setMat3(int location, const glm::mat3& mat) const
+    {
+        glUniformMatrix3fv(location, 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat4(const std::string& name, const glm::mat4& mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat4(get_uniform_location(name), mat);
+    }
+    void setMat4(int location, const glm::mat4& mat) const
+    {
+        glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
     }
 
 private:
+    // uniform name -> location, filled once after linking
+    std::unordered_map<std::string, int> uniforms;
+
+    // #version has to stay the first line. The #line directives keep the line numbers of compile
+    // errors pointing into the right file, source string 1 is the library and 0 the shader itself
+    // ------------------------------------------------------------------------
+    static std::string insert_library(const std::string& code, const std::string& library)
+    {
+        size_t version_end = code.find('\n');
+        if (version_end == std::string::npos)
+        {
+            return code;
+        }
+        return code.substr(0, version_end + 1) + "#line 1 1\n" + library + "\n#line 2 0\n" + code.substr(version_end + 1);
+    }
+
+    // queries every active uniform of the linked program and caches its location.
+    // arrays are reported once as "name[0]", so every element is registered explicitly
+    // ------------------------------------------------------------------------
+    void reflect_uniforms()
+    {
+        int count = 0;
+        int max_length = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+        std::vector<char> buffer(max_length + 1);
+
+        for (int i = 0; i < count; i++) {
+            int length = 0;
+            int size = 0;
+            GLenum type;
+            glGetActiveUniform(ID, i, max_length + 1, &length, &size, &type, buffer.data());
+
+            std::string uniform_name(buffer.data(), length);
+            int location = glGetUniformLocation(ID, uniform_name.c_str());
+            if (location < 0) {
+                continue; // members of uniform blocks have no location
+            }
+            uniforms[uniform_name] = location;
+
+            size_t subscript = uniform_name.size() > 3 ? uniform_name.size() - 3 : 0;
+            if (uniform_name.compare(subscript, 3, "[0]") == 0) {
+                std::string base = uniform_name.substr(0, subscript);
+                uniforms[base] = location;
+                for (int element = 1; element < size; element++) {
+                    std::string element_name = base + "[" + std::to_string(element) + "]";
+                    uniforms[element_name] = glGetUniformLocation(ID, element_name.c_str());
+                }
+            }
+        }
+    }
+
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void check_compile_errors(unsigned int shader, std::string type)
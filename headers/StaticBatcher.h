@@ -0,0 +1,51 @@
+#ifndef STATIC_BATCHER_H
+#define STATIC_BATCHER_H
+
+#include <vector>
+
+#include "Object.h"
+
+// Must match the sampler unit set for "staticMaterials" on the "texture" and "gbuffer" shaders
+const int STATIC_MATERIAL_TEXTURE_UNIT = 7;
+// the number of array layers every GL 3.3 implementation supports
+const int MAX_STATIC_MATERIALS = 256;
+
+// Merges the static objects that share a shader and a texture layout (format, size and mip count,
+// see TextureCache::probe()) into one mesh per group at load time. The vertices are transformed
+// into world space up front, so a whole group draws as a single untransformed instance instead of
+// one instance per object. Objects that aren't static, and groups of one, are rendered as they are.
+//
+// A group using a single texture draws with that texture. The textures of a group using several
+// become the layers of one texture array in their own format, so block compressed textures stay
+// compressed and nothing is rescaled, and every merged vertex carries the layer it samples
+// (MeshRegistry's material buffer). update() copies the textures into the array once they have
+// loaded, until then the batch samples a grey placeholder.
+//
+// A batch has no per-object light lists, main.cpp turns batching off with --object-lights.
+// Only the rendering uses the batches, collision still needs the individual objects.
+class StaticBatcher {
+private:
+	struct MaterialArray {
+		TextureLayout layout;
+		std::vector<Texture*> layers; // holds a reference to each
+		Object* batch;
+		unsigned int ID; // 0 until update() filled it
+	};
+
+	static std::vector<Object*> batches;
+	static std::vector<MaterialArray> arrays;
+	static unsigned int placeholder;
+
+	// group_layers holds the layer of each object in group, NO_MATERIAL for a single texture group
+	static Object* merge(const std::vector<Object*>& group, const std::vector<short>& group_layers);
+	static void fill(MaterialArray& array);
+	// pbo is only used without ARB_copy_image
+	static void copy_layer(const Texture* texture, const MaterialArray& array, int layer, unsigned int pbo);
+public:
+	// fills render_objects with the batches and every object that wasn't batched
+	static void build(const std::vector<Object*>& objects, std::vector<Object*>& render_objects);
+	// copies the textures into the arrays once they have loaded, must run on the GL thread
+	static void update();
+	static void free();
+};
+#endif
@@ -0,0 +1,97 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <tuple>
+
+#include "MappedFile.h"
+
+// what an image turns into on the GPU
+struct TextureLayout {
+    unsigned int format; // sized internal format
+    int width;
+    int height;
+    int levels;
+
+    bool operator<(const TextureLayout& other) const {
+        return std::tie(format, width, height, levels) < std::tie(other.format, other.width, other.height, other.levels);
+    }
+    bool operator==(const TextureLayout& other) const {
+        return format == other.format && width == other.width && height == other.height && levels == other.levels;
+    }
+};
+
+struct Texture {
+    std::string path;
+    unsigned int ID;
+    int references;
+    TextureLayout layout; // the 1x1 placeholder until the image is uploaded
+    bool loading; // false once the image is uploaded or failed to load
+};
+
+// Decodes and uploads every image file once, keyed by its normalized path.
+// Objects using the same material share one reference counted GL texture.
+//
+// Decoding runs on a pool of worker threads: acquire() returns a texture holding a placeholder
+// texel right away and update(), called on the GL thread, uploads finished images through a
+// pixel buffer object.
+//
+// Images cooked by asset_cook ("floor.jpg" -> "floor.ctex" next to it) skip the decode: the worker
+// maps the file and update() uploads its precomputed, block compressed mips straight from the
+// mapping. A cooked file older than its source is ignored.
+class TextureCache {
+private:
+	struct DecodedImage {
+		std::string key;
+		int width;
+		int height;
+		unsigned char* pixels;
+		std::shared_ptr<MappedFile> cooked; // set instead of pixels for cooked textures
+	};
+
+	static std::unordered_map<std::string, Texture*> textures;
+	static std::unordered_map<std::string, std::string> normalized_paths; // path as given, key
+	static int hits;
+	static int misses;
+
+	static std::vector<std::thread> workers;
+	static std::queue<std::pair<std::string, std::string>> pending; // key, path
+	static std::vector<DecodedImage> decoded;
+	static std::mutex mutex;
+	static std::condition_variable work_available;
+	static bool stopping;
+	static int in_flight;
+	static unsigned int pbo;
+
+	static std::string normalize_path(const std::string& path);
+	static unsigned int create_placeholder();
+	static void upload(const DecodedImage& image);
+	static void upload_cooked(const DecodedImage& image);
+	static std::shared_ptr<MappedFile> map_cooked(const std::string& path);
+	static unsigned int cooked_format(const char* data);
+	static void start_workers();
+	static void decode_worker();
+public:
+	static Texture* acquire(const std::string& path);
+	static void release(Texture* texture);
+	// the layout path will have once uploaded, read from the file header without decoding it.
+	// False if the file can't be read
+	static bool probe(const std::string& path, TextureLayout& layout);
+
+	// uploads the images decoded since the last call, must run on the GL thread
+	static void update();
+	// true while an acquired texture is still showing its placeholder
+	static bool is_loading();
+	static void shutdown();
+
+	static int get_hits() { return hits; }
+	static int get_misses() { return misses; }
+};
+#endif
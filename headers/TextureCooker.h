@@ -0,0 +1,13 @@
+#ifndef TEXTURE_COOKER_H
+#define TEXTURE_COOKER_H
+
+#include <string>
+
+// Offline half of the cooked textures: decodes a source image once, builds its mip chain with a box
+// filter and encodes every level as BC1 (opaque) or BC3 (with alpha) next to an RGBA8 copy.
+// The runtime then only maps the file and uploads, see TextureCache.
+class TextureCooker {
+public:
+	static bool cook(const std::string& source_path, const std::string& cooked_path);
+};
+#endif
@@ -1,10 +1,29 @@
 #include <iostream>
 #include <vector>
+#include <string>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <stdexcept>
 
 #include "headers/Camera.h"
 #include "headers/Light.h"
+#include "headers/InstancedRenderer.h"
+#include "headers/RenderQueue.h"
+#include "headers/StaticBatcher.h"
+#include "headers/BVH.h"
+#include "headers/PhysicsWorld.h"
+#include "headers/SceneFile.h"
+#include "headers/GLExtensions.h"
+#include "headers/HeadlessContext.h"
+#include "headers/GLRecorder.h"
+#include "headers/Profiler.h"
 #include "headers/ShaderManager.h"
 #include "headers/PointLightManager.h"
+#include "headers/ClusterGrid.h"
+#include "headers/DeferredRenderer.h"
 
 #include <GLFW/glfw3.h>
 
@@ -13,6 +32,8 @@
 
 const int SCREEN_WIDTH = 1280;
 const int SCREEN_HEIGHT = 720;
+int viewport_width = SCREEN_WIDTH;
+int viewport_height = SCREEN_HEIGHT;
 
 // camera
 Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
@@ -25,8 +46,23 @@ bool window_light_keys_pressed_last_frame[4] = {false, false, false, false};
 float delta_time = 0.0f; // Time between current frame and last frame
 float last_frame = 0.0f;  // Time of last frame
 
+// The simulation (input, camera movement, collision) advances in fixed steps, independent of the
+// frame rate. Frames render the camera interpolated between the last two steps
+const float FIXED_TIMESTEP = 1.0f / 60.0f;
+const int MAX_UPDATE_STEPS = 5; // per frame, a long stall is dropped instead of being caught up
+float update_accumulator = 0.0f;
+
 std::vector<Object*> room_objects = {};
+std::vector<Object*> render_objects = {}; // room_objects with the static ones merged into batches
 std::vector<Light*> light_objects = {};
+RenderQueue render_queue(FAR_PLANE);
+BVH scene_bvh;
+std::vector<Object*> visible_objects = {};
+int objects_culled = 0;
+int lights_culled = 0;
+bool deferred = false;
+bool object_lights = false;
+bool static_batching = true;
 
 GLFWwindow* window;
 
@@ -35,23 +71,188 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 
 int init();
+int init_headless();
 void render_loop();
+void update_simulation(float time_step);
+void render_frame();
+void update_window_title();
+void run_benchmark(int frames);
+int run_gl_recording(int frames, int max_draw_calls, int max_program_binds);
+void wait_for_textures();
+void print_frame_statistics(std::vector<double> frame_times);
 void load_shaders();
-void load_objects();
-void process_input();
+bool load_objects(const std::string& scene_path);
+void add_light_fixtures(int count);
+void process_input(float time_step);
 void calculate_delta_time();
 
-int main() {
-    if (init() == -1) {
+// printed when an argument is malformed
+const char* USAGE =
+    "usage: opengl_interior [--headless [frames]]\n"
+    "                       [--record-gl [frames] [--max-draw-calls N] [--max-program-binds N]]\n"
+    "                       [--trace first_frame last_frame]  writes trace.json for chrome://tracing\n"
+    "                       [--fixtures N]  adds N ceiling light fixtures\n"
+    "                       [--deferred]  shades through a G-buffer instead of per fragment\n"
+    "                       [--object-lights]  shades the strongest lights per object instead of per cluster,\n"
+    "                                          forward only, turns static batching off\n"
+    "                       [--no-static-batching]  draws static objects one by one\n"
+    "                       [--no-multi-draw-indirect]  one instanced draw per group even if the driver has ARB_multi_draw_indirect\n"
+    "                       [--light-cutoff X]  attenuation at which a light stops, between 0 and 1, 1/256 by default\n"
+    "                       [--scene path]  text or compiled scene file, ../scenes/room.scene by default\n"
+    "                       [--compile-scene text_path binary_path]  writes the binary form of a scene file and exits\n";
+
+// all of text as a number no smaller than minimum, throws std::invalid_argument otherwise.
+// std::stoi alone would read "12abc" as 12
+static int parse_int(const char* text, int minimum) {
+    size_t used = 0;
+    int value = std::stoi(text, &used);
+    if (text[used] != '\0' || value < minimum) {
+        throw std::invalid_argument(text);
+    }
+    return value;
+}
+
+// all of text as a number strictly between minimum and maximum, which also rules out NaN
+static float parse_float(const char* text, float minimum, float maximum) {
+    size_t used = 0;
+    float value = std::stof(text, &used);
+    if (text[used] != '\0' || !(value > minimum && value < maximum)) {
+        throw std::invalid_argument(text);
+    }
+    return value;
+}
+
+// the value following the option at i, throws std::invalid_argument if the command line ends first
+static const char* next_argument(int& i, int argc, char** argv) {
+    if (i + 1 >= argc) {
+        throw std::invalid_argument(argv[i]);
+    }
+    return argv[++i];
+}
+
+int main(int argc, char** argv) {
+    bool headless = false;
+    bool record_gl = false;
+    int frames = 500;
+    int max_draw_calls = -1;
+    int max_program_binds = -1;
+    int fixtures = 0;
+    std::string scene_path = "../scenes/room.scene";
+    // malformed values and unknown options throw, a typo must not quietly switch off a budget
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string argument = argv[i];
+            if (argument == "--headless" || argument == "--record-gl") {
+                headless = headless || argument == "--headless";
+                record_gl = record_gl || argument == "--record-gl";
+                // the frame count is optional
+                if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                    frames = parse_int(argv[++i], 1);
+                }
+            }
+            else if (argument == "--max-draw-calls") {
+                max_draw_calls = parse_int(next_argument(i, argc, argv), 0);
+            }
+            else if (argument == "--max-program-binds") {
+                max_program_binds = parse_int(next_argument(i, argc, argv), 0);
+            }
+            else if (argument == "--deferred") {
+                deferred = true;
+            }
+            else if (argument == "--object-lights") {
+                // a batch spans many objects, it has no light list of its own
+                object_lights = true;
+                static_batching = false;
+            }
+            else if (argument == "--no-static-batching") {
+                static_batching = false;
+            }
+            else if (argument == "--no-multi-draw-indirect") {
+                InstancedRenderer::set_multi_draw_indirect(false);
+            }
+            else if (argument == "--light-cutoff") {
+                // 0 or less would give every light a radius of 0 and leave the scene dark
+                PointLightManager::set_light_cutoff(parse_float(next_argument(i, argc, argv), 0.0f, 1.0f));
+            }
+            else if (argument == "--fixtures") {
+                fixtures = parse_int(next_argument(i, argc, argv), 0);
+            }
+            else if (argument == "--scene") {
+                scene_path = next_argument(i, argc, argv);
+            }
+            else if (argument == "--compile-scene") {
+                std::string text_path = next_argument(i, argc, argv);
+                std::string binary_path = next_argument(i, argc, argv);
+                return SceneFile::compile(text_path, binary_path) ? 0 : 1;
+            }
+            else if (argument == "--trace") {
+                int first = parse_int(next_argument(i, argc, argv), 0);
+                int last = parse_int(next_argument(i, argc, argv), first);
+                Profiler::capture(first, last, "trace.json");
+            }
+            else {
+                throw std::invalid_argument(argument);
+            }
+        }
+    }
+    catch (const std::logic_error&) {
+        std::cout << USAGE;
+        return 1;
+    }
+
+    // recording runs on the null driver and doesn't need a context
+    if (record_gl) {
+        GLRecorder::install(GLRecorder::NULL_DRIVER);
+    }
+    else if ((headless ? init_headless() : init()) == -1) {
         return -1;
     }
 
     load_shaders();
-    load_objects();
-    render_loop();
+    if (!load_objects(scene_path)) {
+        return -1;
+    }
+    add_light_fixtures(fixtures);
+    if (static_batching) {
+        StaticBatcher::build(room_objects, render_objects);
+    }
+    else {
+        render_objects = room_objects;
+    }
+    MeshRegistry::discard_cpu_copies();
+    scene_bvh.build(render_objects);
+    PhysicsWorld::init();
+    PhysicsWorld::build(room_objects);
+    PhysicsWorld::create_character(camera.size, camera.position);
+
+    int result = 0;
+    if (record_gl) {
+        result = run_gl_recording(frames, max_draw_calls, max_program_binds);
+    }
+    else if (headless) {
+        run_benchmark(frames);
+    }
+    else {
+        render_loop();
+    }
 
-    glfwTerminate();
-    return 0;
+    Profiler::shutdown();
+    PhysicsWorld::free();
+    StaticBatcher::free();
+    TextureCache::shutdown();
+    if (deferred) {
+        DeferredRenderer::free();
+    }
+    if (record_gl) {
+        GLRecorder::uninstall();
+    }
+    else if (headless) {
+        HeadlessContext::destroy();
+    }
+    else {
+        glfwTerminate();
+    }
+    return result;
 }
 
 int init() {
@@ -86,8 +287,39 @@ int init() {
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    if (!load_gl_extensions((GLADloadproc) glfwGetProcAddress))
+    {
+        std::cout << "Failed to load OpenGL 3.3 entry points" << std::endl;
+        return -1;
+    }
+
+    viewport_width = SCREEN_WIDTH * 2;
+    viewport_height = SCREEN_HEIGHT * 2;
+    glViewport(0, 0, viewport_width, viewport_height);
+    glEnable(GL_DEPTH_TEST);
+
+    return 0;
+}
+
+// offscreen context without a window, frames go to a framebuffer object
+int init_headless() {
+    if (!HeadlessContext::create(SCREEN_WIDTH, SCREEN_HEIGHT))
+    {
+        return -1;
+    }
+    if (!gladLoadGLLoader(HeadlessContext::get_proc_address())
+        || !load_gl_extensions(HeadlessContext::get_proc_address()))
+    {
+        std::cout << "Failed to load OpenGL function pointers" << std::endl;
+        return -1;
+    }
+    if (!HeadlessContext::create_framebuffer(SCREEN_WIDTH, SCREEN_HEIGHT))
+    {
+        return -1;
+    }
+    std::cout << "Headless: " << glGetString(GL_RENDERER) << ", OpenGL " << glGetString(GL_VERSION) << std::endl;
 
-    glViewport(0, 0, SCREEN_WIDTH * 2, SCREEN_HEIGHT * 2);
+    glViewport(0, 0, viewport_width, viewport_height);
     glEnable(GL_DEPTH_TEST);
 
     return 0;
@@ -96,43 +328,224 @@ int init() {
 void render_loop() {
     while (!glfwWindowShouldClose(window))
     {
+        Profiler::begin_frame();
         calculate_delta_time();
-        process_input();
+        update_accumulator += std::min(delta_time, FIXED_TIMESTEP * MAX_UPDATE_STEPS);
+        {
+            ProfileScope scope("update");
+            while (update_accumulator >= FIXED_TIMESTEP) {
+                update_simulation(FIXED_TIMESTEP);
+                update_accumulator -= FIXED_TIMESTEP;
+            }
+        }
+        camera.interpolate(update_accumulator / FIXED_TIMESTEP);
 
-        glClearColor(0.0f, 1.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        render_frame();
+        update_window_title();
 
-        glm::mat4 projection = glm::perspective(glm::radians(camera.zoom), (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
-        ShaderManager::get_shader_by_name("texture")->setMat4("projection", projection);
+        {
+            ProfileScope scope("swap");
+            glfwSwapBuffers(window); // will swap the color buffer (a large 2D buffer that contains color values for each pixel in GLFW's window)
+            glfwPollEvents(); // checks if any events are triggered (like keyboard input or mouse movement events)
+        }
+        Profiler::end_frame();
+    }
+}
 
-        glm::mat4 view = camera.get_view_matrix();
-        ShaderManager::get_shader_by_name("texture")->setMat4("view", view);
+// one fixed timestep: input, camera movement and collision. Rendering only reads the results
+void update_simulation(float time_step) {
+    camera.begin_update();
+    process_input(time_step);
 
-        for (Object* room_object : room_objects) {
-            room_object->draw();
-        }
+    PhysicsWorld::update();
+    camera.position = PhysicsWorld::move_character(camera.previous_position, camera.position);
+}
 
+void render_frame() {
+    {
+        ProfileScope scope("texture upload");
+        TextureCache::update();
+        StaticBatcher::update();
+    }
+    {
+        ProfileScope scope("light upload");
+        PointLightManager::upload();
+    }
+
+    glClearColor(0.0f, 1.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    camera.upload_uniforms((float)SCREEN_WIDTH / (float)SCREEN_HEIGHT);
+    {
+        ProfileScope scope("light clustering");
+        ClusterGrid::update(camera.view, camera.projection, viewport_width, viewport_height);
+    }
+
+    Frustum frustum = Frustum::from_matrix(camera.view_projection);
+    {
+        ProfileScope scope("culling");
+        scene_bvh.update();
+        visible_objects.clear();
+        scene_bvh.cull(frustum, visible_objects);
+        objects_culled = static_cast<int>(render_objects.size() - visible_objects.size());
+
+        render_queue.clear();
+        for (Object* visible_object : visible_objects) {
+            render_queue.push(visible_object, camera.view);
+        }
+        render_queue.sort();
+    }
+    if (deferred) {
+        {
+            ProfileScope scope("draw objects");
+            DeferredRenderer::geometry_pass(render_queue.get_items(), viewport_width, viewport_height);
+        }
+        {
+            ProfileScope scope("deferred lighting");
+            DeferredRenderer::lighting_pass();
+        }
+    }
+    else {
+        ProfileScope scope("draw objects");
+        InstancedRenderer::draw(render_queue.get_items());
+    }
+    {
+        ProfileScope scope("draw lights");
+        lights_culled = 0;
         for (Light* light_object : light_objects) {
+            if (frustum.test(light_object->get_bounds()) == OUTSIDE) {
+                lights_culled++;
+                continue;
+            }
             light_object->draw();
         }
+    }
+}
 
-        glfwSwapBuffers(window); // will swap the color buffer (a large 2D buffer that contains color values for each pixel in GLFW's window)
-        glfwPollEvents(); // checks if any events are triggered (like keyboard input or mouse movement events)
+// shows how much the frustum culling skipped, only when it changed
+void update_window_title() {
+    static int shown_objects_culled = -1;
+    static int shown_lights_culled = -1;
+    if (objects_culled == shown_objects_culled && lights_culled == shown_lights_culled) {
+        return;
     }
+    shown_objects_culled = objects_culled;
+    shown_lights_culled = lights_culled;
+
+    std::string title = "Room - culled " + std::to_string(objects_culled) + " objects, "
+                        + std::to_string(lights_culled) + " lights";
+    glfwSetWindowTitle(window, title.c_str());
 }
 
-void process_input() {
+// renders a fixed number of frames from the default camera and prints frame-time statistics.
+// glFinish() closes every frame, so the times include the GPU work and not only its submission
+void run_benchmark(int frames) {
+    wait_for_textures();
+
+    // a few untimed frames so that shader compilation and first uploads don't skew the results
+    for (int i = 0; i < 10; i++) {
+        render_frame();
+    }
+    glFinish();
+
+    std::vector<double> frame_times;
+    frame_times.reserve(frames);
+    for (int i = 0; i < frames; i++) {
+        auto start = std::chrono::steady_clock::now();
+        Profiler::begin_frame();
+        render_frame();
+        {
+            ProfileScope scope("finish");
+            glFinish();
+        }
+        Profiler::end_frame();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        frame_times.push_back(elapsed.count());
+    }
+
+    print_frame_statistics(frame_times);
+    std::cout << "Culled: " << objects_culled << " of " << render_objects.size() << " objects, "
+              << lights_culled << " of " << light_objects.size() << " lights" << std::endl;
+}
+
+// renders frames on the GL recorder and prints the calls of the last one. Returns 1 if any frame
+// went over one of the budgets (-1 = unlimited), so CI can fail on a regression without a GPU
+int run_gl_recording(int frames, int max_draw_calls, int max_program_binds) {
+    wait_for_textures();
+
+    int result = 0;
+    GLFrameStats stats = {};
+    for (int i = 0; i < frames; i++) {
+        GLRecorder::begin_frame();
+        render_frame();
+        stats = GLRecorder::get_frame_stats();
+
+        if (max_draw_calls >= 0 && stats.draw_calls > max_draw_calls) {
+            result = 1;
+        }
+        if (max_program_binds >= 0 && stats.program_binds > max_program_binds) {
+            result = 1;
+        }
+    }
+
+    std::cout << "GL calls per frame: " << stats.total_calls << std::endl;
+    std::cout << "  draw calls:         " << stats.draw_calls << std::endl;
+    std::cout << "  program binds:      " << stats.program_binds << std::endl;
+    std::cout << "  texture binds:      " << stats.texture_binds << std::endl;
+    std::cout << "  vertex array binds: " << stats.vertex_array_binds << std::endl;
+    std::cout << "  buffer binds:       " << stats.buffer_binds << std::endl;
+    std::cout << "  framebuffer binds:  " << stats.framebuffer_binds << std::endl;
+    std::cout << "  uniform uploads:    " << stats.uniform_uploads << std::endl;
+    std::cout << "  bytes uploaded:     " << stats.bytes_uploaded << std::endl;
+    std::cout << "Culled: " << objects_culled << " of " << render_objects.size() << " objects, "
+              << lights_culled << " of " << light_objects.size() << " lights" << std::endl;
+    if (result != 0) {
+        std::cout << "GL call budget exceeded" << std::endl;
+    }
+    return result;
+}
+
+void wait_for_textures() {
+    while (TextureCache::is_loading()) {
+        TextureCache::update();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // part of loading as well, the copy draws would otherwise land in the first measured frame
+    StaticBatcher::update();
+}
+
+void print_frame_statistics(std::vector<double> frame_times) {
+    std::sort(frame_times.begin(), frame_times.end());
+
+    double total = 0.0;
+    for (double frame_time : frame_times) {
+        total += frame_time;
+    }
+    // nearest-rank percentile
+    auto percentile = [&frame_times](double p) {
+        size_t rank = static_cast<size_t>(p / 100.0 * (frame_times.size() - 1) + 0.5);
+        return frame_times[rank];
+    };
+
+    std::cout << "Frames: " << frame_times.size() << std::endl;
+    std::cout << "Frame time (ms): mean " << total / frame_times.size()
+              << ", p50 " << percentile(50.0)
+              << ", p95 " << percentile(95.0)
+              << ", p99 " << percentile(99.0) << std::endl;
+}
+
+void process_input(float time_step) {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        camera.on_keyboard_input(FORWARD, delta_time, glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS);
+        camera.on_keyboard_input(FORWARD, time_step, glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS);
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        camera.on_keyboard_input(BACKWARD, delta_time, glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS);
+        camera.on_keyboard_input(BACKWARD, time_step, glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS);
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        camera.on_keyboard_input(LEFT, delta_time, glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS);
+        camera.on_keyboard_input(LEFT, time_step, glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS);
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        camera.on_keyboard_input(RIGHT, delta_time, glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS);
+        camera.on_keyboard_input(RIGHT, time_step, glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS);
 
     // Sunrise window color
     if(glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS) {
@@ -141,6 +554,7 @@ void process_input() {
         window_light_keys_pressed_last_frame[0] = false;
         PointLight* light = PointLightManager::get_point_light_by_name("window_light");
         light->ambient = glm::vec3(5.0f, 3.96f, 2.43f) * 0.5f;
+        PointLightManager::mark_dirty();
     }
     // Midday window color
     if(glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS) {
@@ -149,6 +563,7 @@ void process_input() {
         window_light_keys_pressed_last_frame[1] = false;
         PointLight* light = PointLightManager::get_point_light_by_name("window_light");
         light->ambient = glm::vec3(5.0f, 5.0f, 2.19f) * 0.5f;
+        PointLightManager::mark_dirty();
     }
     // Sunset window color
     if(glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS) {
@@ -157,6 +572,7 @@ void process_input() {
         window_light_keys_pressed_last_frame[2] = false;
         PointLight* light = PointLightManager::get_point_light_by_name("window_light");
         light->ambient = glm::vec3(4.9f, 4.19f, 3.23f) * 0.5f;
+        PointLightManager::mark_dirty();
     }
     // Full-moon window color
     if(glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS) {
@@ -165,6 +581,7 @@ void process_input() {
         window_light_keys_pressed_last_frame[3] = false;
         PointLight* light = PointLightManager::get_point_light_by_name("window_light");
         light->ambient = glm::vec3(1.21f, 1.49f, 2.31f) * 0.5f;
+        PointLightManager::mark_dirty();
     }
 
     if(glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) {
@@ -173,117 +590,40 @@ void process_input() {
         space_pressed_last_frame = false;
         PointLight* light = PointLightManager::get_point_light_by_name("screen_light");
         light->on = !light->on;
+        PointLightManager::mark_dirty();
+    }
+}
+
+bool load_objects(const std::string& scene_path) {
+    if (!SceneFile::load(scene_path, room_objects, light_objects)) {
+        return false;
     }
+
+    std::cout << "Texture cache: " << TextureCache::get_hits() << " hits, "
+              << TextureCache::get_misses() << " misses" << std::endl;
+    return true;
 }
 
-void load_objects() {
-    auto* red_chair = new Object("cube1",
-                                 glm::vec3(1.2f, 1.2f, 1.2f),
-                                 glm::vec3(0.0f, 0.1f, 0.0f),
-                                 0.0f,
-                                 glm::vec3(0.0f) + glm::vec3(-6.0f, -1.8f, -6.0f),
-                                 "../resources/chair-red-leather.jpg");
-
-    auto* brown_chair = new Object("cube2",
-                                   glm::vec3(1.2f, 1.2f, 1.2f),
-                                   glm::vec3(0.0f, 0.1f, 0.0f),
-                                   0.0f,
-                                   glm::vec3(0.0f) + glm::vec3(3.0f, -1.8f, 1.0f),
-                                   "../resources/chair-brown-leather.jpg");
-
-    auto* black_chair = new Object("cube3",
-                                   glm::vec3(1.2f, 1.2f, 1.2f),
-                                   glm::vec3(0.0f, 0.1f, 0.0f),
-                                   0.0f,
-                                   glm::vec3(0.0f) + glm::vec3(3.0f, -1.8f, -1.0f),
-                                   "../resources/chair-black-leather.jpg");
-
-    auto* screen = new Object("screen",
-                              glm::vec3(0.01f, 3.2f, 1.6f),
-                              glm::vec3(90.0f, 0.1f, 0.0f),
-                              90.0f,
-                              glm::vec3(0.0f) + glm::vec3(7.1f, 0.5f, 0.0f),
-                              "../resources/screen.jpg");
-
-    auto* wall_window = new Object("window",
-                                   glm::vec3(2.0f, 2.0f, 0.1f),
-                                   glm::vec3(0.0f, 0.05f, 0.0f),
-                                   0.0f,
-                                   glm::vec3(0.0f) + glm::vec3(-3.0f, 0.6f, -7.15f),
-                                   "../resources/window.jpg");
-
-    auto* floor = new Object("floor",
-                             glm::vec3(15.0f, 0.1f, 15.0f),
-                             glm::vec3(0.0f, 0.1f, 0.0f),
-                             0.0f,
-                             glm::vec3(0.0f) + glm::vec3(0.0f, -2.5f, 0.0f),
-                             "../resources/floor.jpg");
-
-    auto* wall1 = new Object("wall1",
-                             glm::vec3(0.75f, 15.0f, 7.0f),
-                             glm::vec3(90.0f, 0.1f, 0.0f),
-                             90.0f,
-                             glm::vec3(0.0f) + glm::vec3(-7.5f, 0.0f, 0.0f),
-                             "../resources/wood-wall.jpg");
-
-    auto* wall2 = new Object("wall2",
-                             glm::vec3(15.0f, 7.0f, 0.75f),
-                             glm::vec3(0.0f, 1.0f, 0.0f),
-                             0.0f,
-                             glm::vec3(0.0f) + glm::vec3(0.0f, 0.0f, -7.5f),
-                             "../resources/wood-wall.jpg");
-
-    auto* wall3 = new Object("wall3",
-                             glm::vec3(15.0f, 7.0f, 0.75f),
-                             glm::vec3(0.0f, 1.0f, 0.0f),
-                             0.0f,
-                             glm::vec3(0.0f) + glm::vec3(0.0f, 0.0f, 7.5f),
-                             "../resources/wood-wall.jpg");
-
-    auto* wall4 = new Object("wall4",
-                             glm::vec3(0.75f, 15.0f, 7.0f),
-                             glm::vec3(90.0f, 0.1f, 0.0f),
-                             90.0f,
-                             glm::vec3(0.0f) + glm::vec3(7.5f, 0.0f, 0.0f),
-                             "../resources/wood-wall.jpg");
-
-    auto* ceiling = new Object("ceiling",
-                               glm::vec3(15.0f, 0.1f, 15.0f),
-                               glm::vec3(0.0f, 0.1f, 0.0f),
-                               0.0f,
-                               glm::vec3(0.0f) + glm::vec3(0.0f, 2.5f, 0.0f),
-                               "../resources/ceiling.jpg");
-
-    room_objects.push_back(red_chair);
-    room_objects.push_back(black_chair);
-    room_objects.push_back(brown_chair);
-
-    room_objects.push_back(wall_window);
-    room_objects.push_back(screen);
-
-    room_objects.push_back(floor);
-    room_objects.push_back(wall1);
-    room_objects.push_back(wall2);
-    room_objects.push_back(wall3);
-    room_objects.push_back(wall4);
-    room_objects.push_back(ceiling);
-
-    auto* screen_light = new Light("window_light",
-                           glm::vec3(0.2f, 0.2f, 0.2f),
-                           glm::vec3(0.0f, 0.1f, 0.0f),
-                           glm::vec3(1.21f, 1.49f, 2.31f),
-                           0.0f,
-                           glm::vec3(0.0f) + glm::vec3(-3.0f, 0.5f, -7.5f));
-
-    auto* window_light = new Light("screen_light",
-                            glm::vec3(0.2f, 0.2f, 0.2f),
-                            glm::vec3(0.0f, 0.1f, 0.0f),
-                            glm::vec3(2.5f, 3.5f, 5.0f),
-                            0.0f,
-                            glm::vec3(0.0f) + glm::vec3(7.5f, 0.8f, 0.0f));
-
-    light_objects.push_back(screen_light);
-    light_objects.push_back(window_light);
+// a grid of small point lights under the ceiling, without lamp meshes, for scenes with many fixtures
+void add_light_fixtures(int count) {
+    if (count <= 0) {
+        return;
+    }
+    int columns = (int) std::ceil(std::sqrt((float) count));
+    float spacing = 14.0f / columns;
+    for (int i = 0; i < count; i++) {
+        glm::vec3 position(-7.0f + spacing * (i % columns + 0.5f), 2.2f, -7.0f + spacing * (i / columns + 0.5f));
+        PointLightManager::add_point_light(new PointLight({"fixture_" + std::to_string(i),
+                                                           true,
+                                                           position,
+                                                           glm::vec3(0.0f),
+                                                           glm::vec3(0.2f, 0.17f, 0.13f),
+                                                           glm::vec3(0.1f),
+                                                           1.0f,
+                                                           0.7f,
+                                                           6.0f}));
+    }
+    std::cout << "Light fixtures: " << count << std::endl;
 }
 
 void calculate_delta_time()
@@ -297,16 +637,66 @@ void load_shaders()
 {
     ShaderManager::add_shader(new Shader("texture",
                                          "../shaders/texture_shader.vs",
-                                         "../shaders/texture_shader.fs"));
+                                         "../shaders/texture_shader.fs",
+                                         "../shaders/lighting.glsl"));
 
     ShaderManager::add_shader(new Shader("light",
                                          "../shaders/texture_lightsource.vs",
                                          "../shaders/texture_lightsource.fs"));
+
+    ShaderManager::get_shader_by_name("texture")->bind_uniform_block("Lights", LIGHTS_BLOCK_BINDING);
+    ShaderManager::get_shader_by_name("texture")->bind_uniform_block("Camera", CAMERA_BLOCK_BINDING);
+    ShaderManager::get_shader_by_name("texture")->bind_uniform_block("Clusters", CLUSTERS_BLOCK_BINDING);
+    ShaderManager::get_shader_by_name("texture")->use();
+    ShaderManager::get_shader_by_name("texture")->setInt("pointLightData", LIGHT_DATA_TEXTURE_UNIT);
+    ShaderManager::get_shader_by_name("texture")->setInt("clusterGrid", CLUSTER_GRID_TEXTURE_UNIT);
+    ShaderManager::get_shader_by_name("texture")->setInt("clusterLightIndices", CLUSTER_INDEX_TEXTURE_UNIT);
+    ShaderManager::get_shader_by_name("texture")->setBool("objectLights", object_lights);
+    // the material is the same for every object
+    ShaderManager::get_shader_by_name("texture")->setInt("material.diffuse", 0);
+    ShaderManager::get_shader_by_name("texture")->setFloat("material.shininess", 32.0f);
+    ShaderManager::get_shader_by_name("texture")->setInt("staticMaterials", STATIC_MATERIAL_TEXTURE_UNIT);
+    InstancedRenderer::set_object_lights(object_lights);
+    ShaderManager::get_shader_by_name("light")->bind_uniform_block("Camera", CAMERA_BLOCK_BINDING);
+
+    if (deferred) {
+        ShaderManager::add_shader(new Shader("gbuffer",
+                                             "../shaders/texture_shader.vs",
+                                             "../shaders/texture_gbuffer.fs"));
+
+        ShaderManager::add_shader(new Shader("deferred_lighting",
+                                             "../shaders/deferred_lighting.vs",
+                                             "../shaders/deferred_lighting.fs",
+                                             "../shaders/lighting.glsl"));
+
+        Shader* gbuffer = ShaderManager::get_shader_by_name("gbuffer");
+        gbuffer->bind_uniform_block("Camera", CAMERA_BLOCK_BINDING);
+        gbuffer->use();
+        gbuffer->setInt("material.diffuse", 0);
+        gbuffer->setFloat("material.shininess", 32.0f);
+        gbuffer->setInt("staticMaterials", STATIC_MATERIAL_TEXTURE_UNIT);
+
+        Shader* lighting = ShaderManager::get_shader_by_name("deferred_lighting");
+        lighting->bind_uniform_block("Lights", LIGHTS_BLOCK_BINDING);
+        lighting->bind_uniform_block("Camera", CAMERA_BLOCK_BINDING);
+        lighting->bind_uniform_block("Clusters", CLUSTERS_BLOCK_BINDING);
+        lighting->use();
+        lighting->setInt("pointLightData", LIGHT_DATA_TEXTURE_UNIT);
+        lighting->setInt("clusterGrid", CLUSTER_GRID_TEXTURE_UNIT);
+        lighting->setInt("clusterLightIndices", CLUSTER_INDEX_TEXTURE_UNIT);
+        lighting->setInt("gAlbedo", GBUFFER_ALBEDO_TEXTURE_UNIT);
+        lighting->setInt("gNormal", GBUFFER_NORMAL_TEXTURE_UNIT);
+        lighting->setInt("gDepth", GBUFFER_DEPTH_TEXTURE_UNIT);
+
+        DeferredRenderer::init(gbuffer, lighting);
+    }
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
+    viewport_width = width;
+    viewport_height = height;
     glViewport(0, 0, width, height);
 }
 
@@ -0,0 +1,120 @@
+#include <algorithm>
+
+#include "headers/BVH.h"
+
+static AABB merge(const AABB& a, const AABB& b) {
+    return {glm::min(a.min, b.min), glm::max(a.max, b.max)};
+}
+
+void BVH::build(const std::vector<Object*>& scene_objects) {
+    source = &scene_objects;
+    objects = scene_objects;
+    nodes.clear();
+    nodes.reserve(objects.empty() ? 0 : 2 * objects.size() - 1);
+    if (!objects.empty()) {
+        build_node(0, static_cast<int>(objects.size()));
+    }
+
+    versions.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); i++) {
+        versions[i] = objects[i]->get_transform_version();
+    }
+}
+
+// splits at the median centroid along the longest axis of the centroids
+int BVH::build_node(int first, int count) {
+    int index = static_cast<int>(nodes.size());
+    nodes.push_back({});
+
+    AABB bounds = objects[first]->get_bounds();
+    AABB centroids = {bounds.get_center(), bounds.get_center()};
+    for (int i = first + 1; i < first + count; i++) {
+        const AABB& object_bounds = objects[i]->get_bounds();
+        bounds = merge(bounds, object_bounds);
+        centroids = merge(centroids, {object_bounds.get_center(), object_bounds.get_center()});
+    }
+
+    if (count <= MAX_LEAF_OBJECTS) {
+        nodes[index] = {bounds, first, 0, count};
+        return index;
+    }
+
+    glm::vec3 extent = centroids.max - centroids.min;
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+    int half = count / 2;
+    std::nth_element(objects.begin() + first, objects.begin() + first + half, objects.begin() + first + count,
+                     [axis](const Object* a, const Object* b) {
+                         return a->get_bounds().get_center()[axis] < b->get_bounds().get_center()[axis];
+                     });
+
+    int left = build_node(first, half);
+    int right = build_node(first + half, count - half);
+    nodes[index] = {bounds, left, right, 0};
+    return index;
+}
+
+void BVH::refit() {
+    for (int i = static_cast<int>(nodes.size()) - 1; i >= 0; i--) {
+        Node& node = nodes[i];
+        if (node.count > 0) {
+            node.bounds = objects[node.first]->get_bounds();
+            for (int j = node.first + 1; j < node.first + node.count; j++) {
+                node.bounds = merge(node.bounds, objects[j]->get_bounds());
+            }
+        }
+        else {
+            node.bounds = merge(nodes[node.first].bounds, nodes[node.right].bounds);
+        }
+    }
+}
+
+void BVH::update() {
+    if (!source) {
+        return;
+    }
+    if (source->size() != objects.size()) {
+        build(*source);
+        return;
+    }
+
+    bool moved = false;
+    for (size_t i = 0; i < objects.size(); i++) {
+        unsigned int version = objects[i]->get_transform_version();
+        if (version != versions[i]) {
+            versions[i] = version;
+            moved = true;
+        }
+    }
+    if (moved) {
+        refit();
+    }
+}
+
+void BVH::cull(const Frustum& frustum, std::vector<Object*>& visible) const {
+    if (!nodes.empty()) {
+        cull_node(0, frustum, false, visible);
+    }
+}
+
+// once a node is completely inside, its whole subtree is visible without further plane tests
+void BVH::cull_node(int index, const Frustum& frustum, bool inside, std::vector<Object*>& visible) const {
+    const Node& node = nodes[index];
+    if (!inside) {
+        FrustumTest test = frustum.test(node.bounds);
+        if (test == OUTSIDE) {
+            return;
+        }
+        inside = test == INSIDE;
+    }
+
+    if (node.count > 0) {
+        for (int i = node.first; i < node.first + node.count; i++) {
+            if (inside || node.count == 1 || frustum.test(objects[i]->get_bounds()) != OUTSIDE) {
+                visible.push_back(objects[i]);
+            }
+        }
+        return;
+    }
+    cull_node(node.first, frustum, inside, visible);
+    cull_node(node.right, frustum, inside, visible);
+}
@@ -1,27 +1,32 @@
 #include "headers/Camera.h"
+#include "external/glfw-3.1.2/deps/glad/glad.h"
 
 Camera* Camera::instance = nullptr;
 
-bool Camera::check_collision(Object* other) const // AABB - AABB collision
-{
-    glm::vec3 pos = glm::vec3(this->position.x - this->size.x / 2,
-                              this->position.y - this->size.y / 2,
-                              this->position.z - this->size.z / 2);
+// std140 layout of the "Camera" block, viewPos is padded to a vec4
+struct CameraBlockStd140 {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::mat4 view_projection;
+    glm::vec4 view_position;
+    glm::mat4 inverse_view_projection;
+};
 
-    glm::vec3 obj_pos = glm::vec3(other->translate_vec.x - other->scale_vec.x / 2,
-                                  other->translate_vec.y - other->scale_vec.y / 2,
-                                  other->translate_vec.z - other->scale_vec.z / 2);
+void Camera::upload_uniforms(float aspect_ratio)
+{
+    view = get_view_matrix();
+    projection = glm::perspective(glm::radians(zoom), aspect_ratio, NEAR_PLANE, FAR_PLANE);
+    view_projection = projection * view;
 
-    // collision x-axis?
-    bool x_collision = pos.x + this->size.x >= obj_pos.x &&
-                       obj_pos.x + other->scale_vec.x >= pos.x;
-    // collision y-axis?
-    bool y_collision = pos.y + this->size.y >= obj_pos.y &&
-                       obj_pos.y + other->scale_vec.y >= pos.y;
-    // collision z-axis?
-    bool z_collision = pos.z + this->size.z >= obj_pos.z &&
-                       obj_pos.z + other->scale_vec.z >= pos.z;
+    CameraBlockStd140 block = {projection, view, view_projection, glm::vec4(render_position, 1.0f), glm::inverse(view_projection)};
 
-    // collision only if on both axes
-    return x_collision && y_collision && z_collision;
-}
\ No newline at end of file
+    if (!ubo) {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlockStd140), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, ubo);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlockStd140), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,208 @@
+#include "headers/ClusterGrid.h"
+#include "headers/PointLightManager.h"
+#include "external/glfw-3.1.2/deps/glad/glad.h"
+
+#include <algorithm>
+#include <cmath>
+
+// std140 layout of the "Clusters" block
+struct ClustersBlockStd140 {
+    glm::vec2 tile_size; // pixels
+    float slice_scale;
+    float slice_bias;
+};
+
+glm::mat4 ClusterGrid::bounds_projection = glm::mat4(0.0f);
+std::vector<AABB> ClusterGrid::bounds = {};
+std::vector<unsigned int> ClusterGrid::cluster_ranges = {};
+std::vector<unsigned short> ClusterGrid::light_indices = {};
+std::vector<std::pair<int, unsigned short>> ClusterGrid::hits = {};
+float ClusterGrid::near_plane = 0.1f;
+float ClusterGrid::far_plane = 100.0f;
+
+unsigned int ClusterGrid::ubo = 0;
+unsigned int ClusterGrid::grid_buffer = 0;
+unsigned int ClusterGrid::grid_texture = 0;
+unsigned int ClusterGrid::index_buffer = 0;
+unsigned int ClusterGrid::index_texture = 0;
+size_t ClusterGrid::index_capacity = 0;
+
+void ClusterGrid::create_buffers() {
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(ClustersBlockStd140), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, CLUSTERS_BLOCK_BINDING, ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glGenBuffers(1, &grid_buffer);
+    glGenTextures(1, &grid_texture);
+    glBindBuffer(GL_TEXTURE_BUFFER, grid_buffer);
+    glBufferData(GL_TEXTURE_BUFFER, CLUSTER_COUNT * 2 * sizeof(unsigned int), nullptr, GL_STREAM_DRAW);
+    glActiveTexture(GL_TEXTURE0 + CLUSTER_GRID_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, grid_texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, grid_buffer);
+
+    index_capacity = 1024;
+    glGenBuffers(1, &index_buffer);
+    glGenTextures(1, &index_texture);
+    glBindBuffer(GL_TEXTURE_BUFFER, index_buffer);
+    glBufferData(GL_TEXTURE_BUFFER, index_capacity * sizeof(unsigned short), nullptr, GL_STREAM_DRAW);
+    glActiveTexture(GL_TEXTURE0 + CLUSTER_INDEX_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, index_texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R16UI, index_buffer);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    cluster_ranges.resize(CLUSTER_COUNT * 2);
+}
+
+// view space bounding box of every cluster, slices are spaced exponentially between the near and far plane
+void ClusterGrid::compute_bounds(const glm::mat4& projection) {
+    bounds_projection = projection;
+    // perspective matrix: [2][2] = -(f + n) / (f - n), [3][2] = -2fn / (f - n)
+    near_plane = projection[3][2] / (projection[2][2] - 1.0f);
+    far_plane = projection[3][2] / (projection[2][2] + 1.0f);
+
+    bounds.resize(CLUSTER_COUNT);
+    for (int z = 0; z < CLUSTER_Z; z++) {
+        float slice_near = near_plane * std::pow(far_plane / near_plane, (float) z / CLUSTER_Z);
+        float slice_far = near_plane * std::pow(far_plane / near_plane, (float) (z + 1) / CLUSTER_Z);
+        for (int y = 0; y < CLUSTER_Y; y++) {
+            float ndc_y[2] = {-1.0f + 2.0f * y / CLUSTER_Y, -1.0f + 2.0f * (y + 1) / CLUSTER_Y};
+            for (int x = 0; x < CLUSTER_X; x++) {
+                float ndc_x[2] = {-1.0f + 2.0f * x / CLUSTER_X, -1.0f + 2.0f * (x + 1) / CLUSTER_X};
+
+                AABB& cluster = bounds[x + y * CLUSTER_X + z * CLUSTER_X * CLUSTER_Y];
+                cluster.min = glm::vec3(INFINITY, INFINITY, -slice_far);
+                cluster.max = glm::vec3(-INFINITY, -INFINITY, -slice_near);
+                for (float depth : {slice_near, slice_far}) {
+                    for (int i = 0; i < 2; i++) {
+                        float view_x = ndc_x[i] * depth / projection[0][0];
+                        float view_y = ndc_y[i] * depth / projection[1][1];
+                        cluster.min.x = std::min(cluster.min.x, view_x);
+                        cluster.max.x = std::max(cluster.max.x, view_x);
+                        cluster.min.y = std::min(cluster.min.y, view_y);
+                        cluster.max.y = std::max(cluster.max.y, view_y);
+                    }
+                }
+            }
+        }
+    }
+}
+
+int ClusterGrid::get_slice(float depth) {
+    int slice = (int) std::floor(std::log(depth / near_plane) / std::log(far_plane / near_plane) * CLUSTER_Z);
+    return std::clamp(slice, 0, CLUSTER_Z - 1);
+}
+
+void ClusterGrid::bin_lights(const glm::mat4& view, const glm::mat4& projection) {
+    hits.clear();
+    const std::vector<PointLight*>& point_lights = PointLightManager::get_point_lights();
+    // the radii PointLightManager::upload() solved this frame, shared with the per-object lists
+    const std::vector<float>& radii = PointLightManager::get_light_radii();
+    int count = std::min(static_cast<int>(radii.size()), MAX_POINT_LIGHTS);
+
+    for (int i = 0; i < count; i++) {
+        const PointLight* light = point_lights[i];
+        float radius = radii[i];
+        if (!light->on || radius <= 0.0f) {
+            continue;
+        }
+
+        glm::vec3 center = glm::vec3(view * glm::vec4(light->position, 1.0f));
+        float closest = -center.z - radius;
+        float farthest = -center.z + radius;
+        if (farthest < near_plane || closest > far_plane) {
+            continue;
+        }
+
+        // narrow the tiles down to the screen rectangle of the light's bounding box, unless the box
+        // reaches behind the near plane where the projection flips
+        int x_first = 0, x_last = CLUSTER_X - 1;
+        int y_first = 0, y_last = CLUSTER_Y - 1;
+        if (closest > near_plane) {
+            glm::vec2 ndc_min(INFINITY), ndc_max(-INFINITY);
+            for (int corner = 0; corner < 8; corner++) {
+                glm::vec3 p = center + radius * glm::vec3(corner & 1 ? 1.0f : -1.0f,
+                                                          corner & 2 ? 1.0f : -1.0f,
+                                                          corner & 4 ? 1.0f : -1.0f);
+                glm::vec2 ndc(projection[0][0] * p.x / -p.z, projection[1][1] * p.y / -p.z);
+                ndc_min = glm::min(ndc_min, ndc);
+                ndc_max = glm::max(ndc_max, ndc);
+            }
+            if (ndc_max.x < -1.0f || ndc_min.x > 1.0f || ndc_max.y < -1.0f || ndc_min.y > 1.0f) {
+                continue;
+            }
+            x_first = std::clamp((int) std::floor((ndc_min.x + 1.0f) * 0.5f * CLUSTER_X), 0, CLUSTER_X - 1);
+            x_last = std::clamp((int) std::floor((ndc_max.x + 1.0f) * 0.5f * CLUSTER_X), 0, CLUSTER_X - 1);
+            y_first = std::clamp((int) std::floor((ndc_min.y + 1.0f) * 0.5f * CLUSTER_Y), 0, CLUSTER_Y - 1);
+            y_last = std::clamp((int) std::floor((ndc_max.y + 1.0f) * 0.5f * CLUSTER_Y), 0, CLUSTER_Y - 1);
+        }
+
+        int z_first = get_slice(std::max(closest, near_plane));
+        int z_last = get_slice(std::min(farthest, far_plane));
+        for (int z = z_first; z <= z_last; z++) {
+            for (int y = y_first; y <= y_last; y++) {
+                for (int x = x_first; x <= x_last; x++) {
+                    int cluster = x + y * CLUSTER_X + z * CLUSTER_X * CLUSTER_Y;
+                    if (bounds[cluster].intersects_sphere(center, radius)) {
+                        hits.emplace_back(cluster, (unsigned short) i);
+                    }
+                }
+            }
+        }
+    }
+
+    // counting sort of the hits by cluster, lights stay in ascending order within a cluster
+    std::fill(cluster_ranges.begin(), cluster_ranges.end(), 0);
+    for (const auto& hit : hits) {
+        cluster_ranges[hit.first * 2 + 1]++;
+    }
+    unsigned int offset = 0;
+    for (int cluster = 0; cluster < CLUSTER_COUNT; cluster++) {
+        cluster_ranges[cluster * 2] = offset;
+        offset += cluster_ranges[cluster * 2 + 1];
+    }
+    light_indices.resize(hits.size());
+    static std::vector<unsigned int> cursor;
+    cursor.assign(CLUSTER_COUNT, 0);
+    for (const auto& hit : hits) {
+        light_indices[cluster_ranges[hit.first * 2] + cursor[hit.first]++] = hit.second;
+    }
+}
+
+void ClusterGrid::upload(int viewport_width, int viewport_height) {
+    ClustersBlockStd140 block;
+    block.tile_size = glm::vec2((float) viewport_width / CLUSTER_X, (float) viewport_height / CLUSTER_Y);
+    // slice = log(depth) * scale + bias, see get_slice()
+    block.slice_scale = CLUSTER_Z / std::log(far_plane / near_plane);
+    block.slice_bias = -CLUSTER_Z * std::log(near_plane) / std::log(far_plane / near_plane);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ClustersBlockStd140), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, grid_buffer);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, cluster_ranges.size() * sizeof(unsigned int), cluster_ranges.data());
+
+    // orphan the index buffer every frame, it grows to the largest list seen so far
+    glBindBuffer(GL_TEXTURE_BUFFER, index_buffer);
+    index_capacity = std::max(index_capacity, light_indices.size());
+    glBufferData(GL_TEXTURE_BUFFER, index_capacity * sizeof(unsigned short), nullptr, GL_STREAM_DRAW);
+    if (!light_indices.empty()) {
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, light_indices.size() * sizeof(unsigned short), light_indices.data());
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void ClusterGrid::update(const glm::mat4& view, const glm::mat4& projection, int viewport_width, int viewport_height) {
+    if (!ubo) {
+        create_buffers();
+    }
+    if (projection != bounds_projection) {
+        compute_bounds(projection);
+    }
+
+    bin_lights(view, projection);
+    upload(viewport_width, viewport_height);
+}
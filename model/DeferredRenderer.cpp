@@ -0,0 +1,113 @@
+#include <iostream>
+
+#include "headers/DeferredRenderer.h"
+#include "headers/InstancedRenderer.h"
+
+unsigned int DeferredRenderer::fbo = 0;
+unsigned int DeferredRenderer::albedo_texture = 0;
+unsigned int DeferredRenderer::normal_texture = 0;
+unsigned int DeferredRenderer::depth_texture = 0;
+unsigned int DeferredRenderer::empty_vao = 0;
+int DeferredRenderer::width = 0;
+int DeferredRenderer::height = 0;
+int DeferredRenderer::target_fbo = 0;
+const Shader* DeferredRenderer::geometry_shader = nullptr;
+const Shader* DeferredRenderer::lighting_shader = nullptr;
+
+static unsigned int create_target_texture(GLint internal_format, GLenum format, GLenum type, int width, int height) {
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+void DeferredRenderer::init(const Shader* geometry_shader, const Shader* lighting_shader) {
+    DeferredRenderer::geometry_shader = geometry_shader;
+    DeferredRenderer::lighting_shader = lighting_shader;
+    // the lighting pass generates its triangle from gl_VertexID, but core profile draws need a vertex array
+    glGenVertexArrays(1, &empty_vao);
+}
+
+bool DeferredRenderer::create_gbuffer(int width, int height) {
+    DeferredRenderer::width = width;
+    DeferredRenderer::height = height;
+
+    glActiveTexture(GL_TEXTURE0);
+    albedo_texture = create_target_texture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height);
+    // world space normals need the sign and more than 8 bits, alpha holds the shininess
+    normal_texture = create_target_texture(GL_RGBA16F, GL_RGBA, GL_FLOAT, width, height);
+    depth_texture = create_target_texture(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, width, height);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedo_texture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normal_texture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth_texture, 0);
+    GLenum attachments[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, attachments);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "G-buffer framebuffer is incomplete" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void DeferredRenderer::destroy_gbuffer() {
+    if (fbo) {
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteTextures(1, &albedo_texture);
+        glDeleteTextures(1, &normal_texture);
+        glDeleteTextures(1, &depth_texture);
+        fbo = 0;
+    }
+}
+
+void DeferredRenderer::geometry_pass(const std::vector<DrawItem>& items, int viewport_width, int viewport_height) {
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target_fbo);
+
+    if (!fbo || viewport_width != width || viewport_height != height) {
+        destroy_gbuffer();
+        create_gbuffer(viewport_width, viewport_height);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    InstancedRenderer::draw(items, geometry_shader);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, target_fbo);
+}
+
+void DeferredRenderer::lighting_pass() {
+    glActiveTexture(GL_TEXTURE0 + GBUFFER_ALBEDO_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, albedo_texture);
+    glActiveTexture(GL_TEXTURE0 + GBUFFER_NORMAL_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, normal_texture);
+    glActiveTexture(GL_TEXTURE0 + GBUFFER_DEPTH_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, depth_texture);
+    glActiveTexture(GL_TEXTURE0);
+
+    // every pixel is written once, with the depth the geometry pass found
+    glDepthFunc(GL_ALWAYS);
+    lighting_shader->use();
+    glBindVertexArray(empty_vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glDepthFunc(GL_LESS);
+}
+
+void DeferredRenderer::free() {
+    destroy_gbuffer();
+    if (empty_vao) {
+        glDeleteVertexArrays(1, &empty_vao);
+        empty_vao = 0;
+    }
+}
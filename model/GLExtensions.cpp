@@ -0,0 +1,41 @@
+#include <cstring>
+
+#include "headers/GLExtensions.h"
+
+PFNGLVERTEXATTRIBDIVISORPROC ext_glVertexAttribDivisor = nullptr;
+PFNGLGETQUERYOBJECTUI64VPROC ext_glGetQueryObjectui64v = nullptr;
+bool ext_texture_compression_s3tc = false;
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC ext_glMultiDrawElementsIndirect = nullptr;
+bool ext_multi_draw_indirect = false;
+PFNGLCOPYIMAGESUBDATAPROC ext_glCopyImageSubData = nullptr;
+bool ext_copy_image = false;
+
+static bool has_extension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (extension && std::strcmp(extension, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool load_gl_extensions(GLADloadproc load) {
+    ext_glVertexAttribDivisor = (PFNGLVERTEXATTRIBDIVISORPROC) load("glVertexAttribDivisor");
+    ext_glGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC) load("glGetQueryObjectui64v");
+    ext_texture_compression_s3tc = has_extension("GL_EXT_texture_compression_s3tc");
+    bool base_instance = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 2)
+                         || has_extension("GL_ARB_base_instance");
+    if (base_instance && has_extension("GL_ARB_multi_draw_indirect")) {
+        ext_glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC) load("glMultiDrawElementsIndirect");
+    }
+    ext_multi_draw_indirect = ext_glMultiDrawElementsIndirect != nullptr;
+    if (GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3) || has_extension("GL_ARB_copy_image")) {
+        ext_glCopyImageSubData = (PFNGLCOPYIMAGESUBDATAPROC) load("glCopyImageSubData");
+    }
+    ext_copy_image = ext_glCopyImageSubData != nullptr;
+
+    return ext_glVertexAttribDivisor != nullptr;
+}
@@ -0,0 +1,319 @@
+#include <type_traits>
+
+#include "headers/GLRecorder.h"
+#include "headers/GLExtensions.h"
+
+enum CallType {
+    OTHER,
+    DRAW,
+    PROGRAM_BIND,
+    TEXTURE_BIND,
+    VERTEX_ARRAY_BIND,
+    BUFFER_BIND,
+    FRAMEBUFFER_BIND,
+    UNIFORM
+};
+
+static GLFrameStats frame_stats = {};
+static bool installed = false;
+static bool unpack_buffer_bound = false;
+static GLuint next_name = 1;
+
+static void record(CallType type) {
+    frame_stats.total_calls++;
+    switch (type) {
+        case DRAW: frame_stats.draw_calls++; break;
+        case PROGRAM_BIND: frame_stats.program_binds++; break;
+        case TEXTURE_BIND: frame_stats.texture_binds++; break;
+        case VERTEX_ARRAY_BIND: frame_stats.vertex_array_binds++; break;
+        case BUFFER_BIND: frame_stats.buffer_binds++; break;
+        case FRAMEBUFFER_BIND: frame_stats.framebuffer_binds++; break;
+        case UNIFORM: frame_stats.uniform_uploads++; break;
+        case OTHER: break;
+    }
+}
+
+// Replaces the function pointer in Slot with a wrapper that records the call as Type.
+// Before runs ahead of the real function (to count bytes), Null stands in for it when there is no
+// real function (NULL_DRIVER) and provides return values or out parameters.
+template <auto* Slot, CallType Type, auto Before = nullptr, auto Null = nullptr,
+          typename Function = std::remove_pointer_t<decltype(Slot)>>
+struct Hook;
+
+template <auto* Slot, CallType Type, auto Before, auto Null, typename R, typename... Args>
+struct Hook<Slot, Type, Before, Null, R (APIENTRYP)(Args...)> {
+    static inline R (APIENTRYP original)(Args...) = nullptr;
+
+    static R APIENTRY call(Args... args) {
+        record(Type);
+        if constexpr (!std::is_null_pointer_v<decltype(Before)>) {
+            Before(args...);
+        }
+        if (original) {
+            return original(args...);
+        }
+        if constexpr (!std::is_null_pointer_v<decltype(Null)>) {
+            return Null(args...);
+        }
+        else {
+            return R();
+        }
+    }
+
+    static void install(bool forward) {
+        original = forward ? *Slot : nullptr;
+        *Slot = call;
+    }
+
+    static void uninstall() {
+        *Slot = original;
+    }
+};
+
+template <typename... Hooks>
+struct HookList {
+    static void install(bool forward) { (Hooks::install(forward), ...); }
+    static void uninstall() { (Hooks::uninstall(), ...); }
+};
+
+// bytes that reach the GPU ------------------------------------------------------------------------
+
+static size_t pixel_size(GLenum format, GLenum type) {
+    size_t components = 4;
+    switch (format) {
+        case GL_RED: case GL_DEPTH_COMPONENT: components = 1; break;
+        case GL_RG: components = 2; break;
+        case GL_RGB: components = 3; break;
+        default: break;
+    }
+    return components * (type == GL_UNSIGNED_BYTE ? 1 : 4);
+}
+
+static void count_buffer_data(GLenum, GLsizeiptr size, const void* data, GLenum) {
+    if (data) {
+        frame_stats.bytes_uploaded += size;
+    }
+}
+
+static void count_buffer_sub_data(GLenum, GLintptr, GLsizeiptr size, const void*) {
+    frame_stats.bytes_uploaded += size;
+}
+
+static void count_map_buffer_range(GLenum, GLintptr, GLsizeiptr length, GLbitfield access) {
+    if (access & GL_MAP_WRITE_BIT) {
+        frame_stats.bytes_uploaded += length;
+    }
+}
+
+static void track_bind_buffer(GLenum target, GLuint buffer) {
+    if (target == GL_PIXEL_UNPACK_BUFFER) {
+        unpack_buffer_bound = buffer != 0;
+    }
+}
+
+// pixels coming from a pixel buffer object were already counted when the buffer was filled
+static void count_tex_image_2d(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type, const void* pixels) {
+    if (pixels && !unpack_buffer_bound) {
+        frame_stats.bytes_uploaded += width * height * pixel_size(format, type);
+    }
+}
+
+static void count_tex_image_3d(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth, GLint, GLenum format, GLenum type, const void* pixels) {
+    if (pixels && !unpack_buffer_bound) {
+        frame_stats.bytes_uploaded += width * height * depth * pixel_size(format, type);
+    }
+}
+
+static void count_compressed_tex_image_2d(GLenum, GLint, GLenum, GLsizei, GLsizei, GLint, GLsizei size, const void* data) {
+    if (data && !unpack_buffer_bound) {
+        frame_stats.bytes_uploaded += size;
+    }
+}
+
+static void count_tex_sub_image_2d(GLenum, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels) {
+    if (pixels && !unpack_buffer_bound) {
+        frame_stats.bytes_uploaded += width * height * pixel_size(format, type);
+    }
+}
+
+// stand-ins for NULL_DRIVER ------------------------------------------------------------------------
+
+static void null_gen(GLsizei count, GLuint* names) {
+    for (GLsizei i = 0; i < count; i++) {
+        names[i] = next_name++;
+    }
+}
+
+static GLuint null_create_shader(GLenum) {
+    return next_name++;
+}
+
+static GLuint null_create_program() {
+    return next_name++;
+}
+
+// compile and link always succeed, a program has no active uniforms
+static void null_get_object_iv(GLuint, GLenum name, GLint* params) {
+    *params = (name == GL_COMPILE_STATUS || name == GL_LINK_STATUS) ? GL_TRUE : 0;
+}
+
+static void null_get_integer_v(GLenum, GLint* data) {
+    *data = 0;
+}
+
+static const GLubyte* null_get_string(GLenum) {
+    return (const GLubyte*) "GLRecorder null driver";
+}
+
+static GLint null_get_uniform_location(GLuint, const GLchar*) {
+    return -1;
+}
+
+static GLuint null_get_uniform_block_index(GLuint, const GLchar*) {
+    return GL_INVALID_INDEX;
+}
+
+static GLenum null_check_framebuffer_status(GLenum) {
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+static GLboolean null_unmap_buffer(GLenum) {
+    return GL_TRUE;
+}
+
+// queries are available right away and measured nothing
+static void null_get_query_object_iv(GLuint, GLenum name, GLint* params) {
+    *params = name == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+static void null_get_query_object_ui64v(GLuint, GLenum, GLuint64* params) {
+    *params = 0;
+}
+
+using AllHooks = HookList<
+    // draws
+    Hook<&glad_glDrawArrays, DRAW>,
+    Hook<&glad_glDrawArraysInstanced, DRAW>,
+    Hook<&glad_glDrawElements, DRAW>,
+    Hook<&glad_glDrawElementsInstanced, DRAW>,
+    Hook<&glad_glDrawElementsBaseVertex, DRAW>,
+    Hook<&glad_glDrawElementsInstancedBaseVertex, DRAW>,
+    Hook<&ext_glMultiDrawElementsIndirect, DRAW>,
+    Hook<&glad_glClear, OTHER>,
+    Hook<&glad_glClearColor, OTHER>,
+    // binds
+    Hook<&glad_glUseProgram, PROGRAM_BIND>,
+    Hook<&glad_glBindTexture, TEXTURE_BIND>,
+    Hook<&glad_glBindVertexArray, VERTEX_ARRAY_BIND>,
+    Hook<&glad_glBindBuffer, BUFFER_BIND, track_bind_buffer>,
+    Hook<&glad_glBindBufferBase, BUFFER_BIND>,
+    Hook<&glad_glBindFramebuffer, FRAMEBUFFER_BIND>,
+    Hook<&glad_glBindRenderbuffer, OTHER>,
+    Hook<&glad_glActiveTexture, OTHER>,
+    // uniforms
+    Hook<&glad_glUniform1i, UNIFORM>,
+    Hook<&glad_glUniform1f, UNIFORM>,
+    Hook<&glad_glUniform2f, UNIFORM>,
+    Hook<&glad_glUniform2fv, UNIFORM>,
+    Hook<&glad_glUniform3f, UNIFORM>,
+    Hook<&glad_glUniform3fv, UNIFORM>,
+    Hook<&glad_glUniform4f, UNIFORM>,
+    Hook<&glad_glUniform4fv, UNIFORM>,
+    Hook<&glad_glUniformMatrix2fv, UNIFORM>,
+    Hook<&glad_glUniformMatrix3fv, UNIFORM>,
+    Hook<&glad_glUniformMatrix4fv, UNIFORM>,
+    Hook<&glad_glUniformBlockBinding, OTHER>,
+    Hook<&glad_glGetUniformLocation, OTHER, nullptr, null_get_uniform_location>,
+    Hook<&glad_glGetUniformBlockIndex, OTHER, nullptr, null_get_uniform_block_index>,
+    Hook<&glad_glGetActiveUniform, OTHER>,
+    // buffers and vertex arrays
+    Hook<&glad_glGenBuffers, OTHER, nullptr, null_gen>,
+    Hook<&glad_glDeleteBuffers, OTHER>,
+    Hook<&glad_glBufferData, OTHER, count_buffer_data>,
+    Hook<&glad_glBufferSubData, OTHER, count_buffer_sub_data>,
+    Hook<&glad_glCopyBufferSubData, OTHER>,
+    Hook<&glad_glMapBufferRange, OTHER, count_map_buffer_range>,
+    Hook<&glad_glUnmapBuffer, OTHER, nullptr, null_unmap_buffer>,
+    Hook<&glad_glGenVertexArrays, OTHER, nullptr, null_gen>,
+    Hook<&glad_glDeleteVertexArrays, OTHER>,
+    Hook<&glad_glVertexAttribPointer, OTHER>,
+    Hook<&glad_glVertexAttribIPointer, OTHER>,
+    Hook<&glad_glEnableVertexAttribArray, OTHER>,
+    Hook<&ext_glVertexAttribDivisor, OTHER>,
+    // textures
+    Hook<&glad_glGenTextures, OTHER, nullptr, null_gen>,
+    Hook<&glad_glDeleteTextures, OTHER>,
+    Hook<&glad_glTexImage2D, OTHER, count_tex_image_2d>,
+    Hook<&glad_glTexImage3D, OTHER, count_tex_image_3d>,
+    Hook<&glad_glTexSubImage3D, OTHER>,
+    Hook<&glad_glCompressedTexImage3D, OTHER>,
+    Hook<&glad_glCompressedTexSubImage3D, OTHER>,
+    Hook<&glad_glGetTexImage, OTHER>,
+    Hook<&glad_glGetCompressedTexImage, OTHER>,
+    Hook<&ext_glCopyImageSubData, OTHER>,
+    Hook<&glad_glTexSubImage2D, OTHER, count_tex_sub_image_2d>,
+    Hook<&glad_glCompressedTexImage2D, OTHER, count_compressed_tex_image_2d>,
+    Hook<&glad_glTexParameteri, OTHER>,
+    Hook<&glad_glTexBuffer, OTHER>,
+    Hook<&glad_glGenerateMipmap, OTHER>,
+    Hook<&glad_glPixelStorei, OTHER>,
+    // shaders
+    Hook<&glad_glCreateShader, OTHER, nullptr, null_create_shader>,
+    Hook<&glad_glShaderSource, OTHER>,
+    Hook<&glad_glCompileShader, OTHER>,
+    Hook<&glad_glGetShaderiv, OTHER, nullptr, null_get_object_iv>,
+    Hook<&glad_glGetShaderInfoLog, OTHER>,
+    Hook<&glad_glDeleteShader, OTHER>,
+    Hook<&glad_glCreateProgram, OTHER, nullptr, null_create_program>,
+    Hook<&glad_glAttachShader, OTHER>,
+    Hook<&glad_glLinkProgram, OTHER>,
+    Hook<&glad_glGetProgramiv, OTHER, nullptr, null_get_object_iv>,
+    Hook<&glad_glGetProgramInfoLog, OTHER>,
+    // framebuffers and global state
+    Hook<&glad_glGenFramebuffers, OTHER, nullptr, null_gen>,
+    Hook<&glad_glDeleteFramebuffers, OTHER>,
+    Hook<&glad_glCheckFramebufferStatus, OTHER, nullptr, null_check_framebuffer_status>,
+    Hook<&glad_glGenRenderbuffers, OTHER, nullptr, null_gen>,
+    Hook<&glad_glDeleteRenderbuffers, OTHER>,
+    Hook<&glad_glRenderbufferStorage, OTHER>,
+    Hook<&glad_glFramebufferRenderbuffer, OTHER>,
+    Hook<&glad_glFramebufferTexture2D, OTHER>,
+    Hook<&glad_glDrawBuffers, OTHER>,
+    Hook<&glad_glGenQueries, OTHER, nullptr, null_gen>,
+    Hook<&glad_glDeleteQueries, OTHER>,
+    Hook<&glad_glBeginQuery, OTHER>,
+    Hook<&glad_glEndQuery, OTHER>,
+    Hook<&glad_glGetQueryObjectiv, OTHER, nullptr, null_get_query_object_iv>,
+    Hook<&ext_glGetQueryObjectui64v, OTHER, nullptr, null_get_query_object_ui64v>,
+    Hook<&glad_glViewport, OTHER>,
+    Hook<&glad_glEnable, OTHER>,
+    Hook<&glad_glDepthFunc, OTHER>,
+    Hook<&glad_glFinish, OTHER>,
+    Hook<&glad_glGetIntegerv, OTHER, nullptr, null_get_integer_v>,
+    Hook<&glad_glGetString, OTHER, nullptr, null_get_string>
+>;
+
+void GLRecorder::install(Mode mode) {
+    if (installed) {
+        return;
+    }
+    AllHooks::install(mode == FORWARD);
+    installed = true;
+    begin_frame();
+}
+
+void GLRecorder::uninstall() {
+    if (!installed) {
+        return;
+    }
+    AllHooks::uninstall();
+    installed = false;
+}
+
+void GLRecorder::begin_frame() {
+    frame_stats = {};
+}
+
+const GLFrameStats& GLRecorder::get_frame_stats() {
+    return frame_stats;
+}
@@ -0,0 +1,207 @@
+#include <cstddef>
+#include <algorithm>
+
+#include "headers/InstancedRenderer.h"
+#include "headers/GLExtensions.h"
+#include "headers/StaticBatcher.h"
+
+unsigned int InstancedRenderer::instance_vbo = 0;
+size_t InstancedRenderer::instance_capacity = 0;
+std::vector<InstanceData> InstancedRenderer::instances = {};
+bool InstancedRenderer::object_lights = false;
+std::unordered_map<const Object*, InstancedRenderer::CachedLights> InstancedRenderer::light_cache = {};
+unsigned int InstancedRenderer::indirect_buffer = 0;
+size_t InstancedRenderer::indirect_capacity = 0;
+std::vector<DrawElementsIndirectCommand> InstancedRenderer::commands = {};
+bool InstancedRenderer::multi_draw_indirect = true;
+
+static bool same_group(const Object* a, const Object* b) {
+    return a->get_shader() == b->get_shader() && a->get_mesh() == b->get_mesh() && a->get_texture() == b->get_texture()
+        && a->get_material_array() == b->get_material_array();
+}
+
+// the items of a group start at [first, returned index)
+static size_t find_group_end(const std::vector<DrawItem>& items, size_t first) {
+    size_t last = first + 1;
+    while (last < items.size() && same_group(items[first].object, items[last].object)) {
+        last++;
+    }
+    return last;
+}
+
+struct BoundState {
+    const Shader* shader = nullptr;
+    unsigned int texture = 0;
+    unsigned int material_array = 0;
+    unsigned int vertex_array = 0;
+};
+
+static void bind_state(BoundState& bound, const Object* object, const Shader* shader_override) {
+    const Shader* shader = shader_override ? shader_override : object->get_shader();
+    if (shader != bound.shader) {
+        bound.shader = shader;
+        bound.shader->use();
+    }
+    if (object->get_texture() != bound.texture) {
+        bound.texture = object->get_texture();
+        glBindTexture(GL_TEXTURE_2D, bound.texture);
+    }
+    // objects without one leave the last array bound, their vertices never sample it
+    if (object->get_material_array() && object->get_material_array() != bound.material_array) {
+        bound.material_array = object->get_material_array();
+        glActiveTexture(GL_TEXTURE0 + STATIC_MATERIAL_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, bound.material_array);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    if (object->get_mesh()->VAO != bound.vertex_array) {
+        bound.vertex_array = object->get_mesh()->VAO;
+        glBindVertexArray(bound.vertex_array);
+    }
+}
+
+// true if b can be drawn without changing the state bound for a
+static bool same_state(const Object* a, const Object* b, const Shader* shader_override) {
+    return (shader_override || a->get_shader() == b->get_shader()) && a->get_texture() == b->get_texture()
+        && (!b->get_material_array() || a->get_material_array() == b->get_material_array())
+        && a->get_mesh()->VAO == b->get_mesh()->VAO;
+}
+
+void InstancedRenderer::draw(const std::vector<DrawItem>& items, const Shader* shader_override) {
+    if (items.empty()) {
+        return;
+    }
+
+    // instances are written in queue order, so every group is a contiguous range of the buffer
+    instances.resize(items.size());
+    for (size_t i = 0; i < items.size(); i++) {
+        instances[i].model = items[i].object->get_model_matrix();
+        instances[i].normal = items[i].object->get_normal_matrix();
+        if (object_lights) {
+            const Object* object = items[i].object;
+            auto inserted = light_cache.try_emplace(object);
+            CachedLights& cached = inserted.first->second;
+            if (inserted.second || cached.transform_version != object->get_transform_version()
+                || cached.lights_version != PointLightManager::get_version()) {
+                PointLightManager::find_relevant_lights(object->get_bounds(), cached.lights);
+                cached.transform_version = object->get_transform_version();
+                cached.lights_version = PointLightManager::get_version();
+            }
+            std::copy_n(cached.lights, MAX_OBJECT_LIGHTS, instances[i].lights);
+        }
+        else {
+            std::fill(instances[i].lights, instances[i].lights + MAX_OBJECT_LIGHTS, -1);
+        }
+    }
+
+    if (!instance_vbo) {
+        glGenBuffers(1, &instance_vbo);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+    if (instances.size() > instance_capacity) {
+        instance_capacity = instances.size();
+        glBufferData(GL_ARRAY_BUFFER, instance_capacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(InstanceData), instances.data());
+
+    glActiveTexture(GL_TEXTURE0);
+    if (multi_draw_indirect && ext_multi_draw_indirect) {
+        draw_indirect(items, shader_override);
+    }
+    else {
+        draw_instanced(items, shader_override);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstancedRenderer::draw_instanced(const std::vector<DrawItem>& items, const Shader* shader_override) {
+    BoundState bound;
+    size_t first = 0;
+    while (first < items.size()) {
+        size_t last = find_group_end(items, first);
+        const Object* object = items[first].object;
+        const Mesh* mesh = object->get_mesh();
+        bind_state(bound, object, shader_override);
+
+        bind_instance_attributes(first);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh->index_count, GL_UNSIGNED_INT,
+                                          (void*)(mesh->first_index * sizeof(unsigned int)),
+                                          static_cast<int>(last - first), mesh->base_vertex);
+        first = last;
+    }
+}
+
+void InstancedRenderer::draw_indirect(const std::vector<DrawItem>& items, const Shader* shader_override) {
+    // the base instance of a command is also the index of its group's first item
+    commands.clear();
+    size_t first = 0;
+    while (first < items.size()) {
+        size_t last = find_group_end(items, first);
+        const Mesh* mesh = items[first].object->get_mesh();
+        commands.push_back({static_cast<unsigned int>(mesh->index_count), static_cast<unsigned int>(last - first),
+                            static_cast<unsigned int>(mesh->first_index), mesh->base_vertex,
+                            static_cast<unsigned int>(first)});
+        first = last;
+    }
+
+    if (!indirect_buffer) {
+        glGenBuffers(1, &indirect_buffer);
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer);
+    if (commands.size() > indirect_capacity) {
+        indirect_capacity = commands.size();
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, indirect_capacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW);
+    }
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+
+    BoundState bound;
+    size_t first_command = 0;
+    while (first_command < commands.size()) {
+        const Object* object = items[commands[first_command].base_instance].object;
+        size_t last_command = first_command + 1;
+        while (last_command < commands.size()
+               && same_state(object, items[commands[last_command].base_instance].object, shader_override)) {
+            last_command++;
+        }
+
+        bool vertex_array_changed = object->get_mesh()->VAO != bound.vertex_array;
+        bind_state(bound, object, shader_override);
+        if (vertex_array_changed) {
+            bind_instance_attributes(0);
+        }
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                    (void*)(first_command * sizeof(DrawElementsIndirectCommand)),
+                                    static_cast<int>(last_command - first_command), 0);
+        first_command = last_command;
+    }
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+// GL 3.3 has no base instance, so the attribute pointers of the bound vertex array are offset
+// to the group's first instance instead
+void InstancedRenderer::bind_instance_attributes(size_t first_instance) {
+    size_t base = first_instance * sizeof(InstanceData);
+    for (int column = 0; column < 4; column++) {
+        int location = INSTANCE_MODEL_LOCATION + column;
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void*)(base + offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+    for (int column = 0; column < 3; column++) {
+        int location = INSTANCE_NORMAL_LOCATION + column;
+        glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void*)(base + offsetof(InstanceData, normal) + column * sizeof(glm::vec3)));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+    for (int i = 0; i < MAX_OBJECT_LIGHTS / 4; i++) {
+        int location = INSTANCE_LIGHTS_LOCATION + i;
+        glVertexAttribIPointer(location, 4, GL_INT, sizeof(InstanceData),
+                               (void*)(base + offsetof(InstanceData, lights) + i * 4 * sizeof(int)));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+}
@@ -6,56 +6,6 @@
 #include "headers/Light.h"
 #include "headers/PointLightManager.h"
 #include "headers/ShaderManager.h"
-#include "headers/Camera.h"
-
-float lamp_vertices[] = {
-   -0.5f, -0.5f, -0.5f,
-     0.5f, -0.5f, -0.5f,
-     0.5f,  0.5f, -0.5f,
-     0.5f,  0.5f, -0.5f,
-    -0.5f,  0.5f, -0.5f,
-    -0.5f, -0.5f, -0.5f,
-
-    -0.5f, -0.5f,  0.5f,
-     0.5f, -0.5f,  0.5f,
-     0.5f,  0.5f,  0.5f,
-     0.5f,  0.5f,  0.5f,
-    -0.5f,  0.5f,  0.5f,
-    -0.5f, -0.5f,  0.5f,
-
-    -0.5f,  0.5f,  0.5f,
-    -0.5f,  0.5f, -0.5f,
-    -0.5f, -0.5f, -0.5f,
-    -0.5f, -0.5f, -0.5f,
-    -0.5f, -0.5f,  0.5f,
-    -0.5f,  0.5f,  0.5f,
-
-     0.5f,  0.5f,  0.5f,
-     0.5f,  0.5f, -0.5f,
-     0.5f, -0.5f, -0.5f,
-     0.5f, -0.5f, -0.5f,
-     0.5f, -0.5f,  0.5f,
-     0.5f,  0.5f,  0.5f,
-
-    -0.5f, -0.5f, -0.5f,
-     0.5f, -0.5f, -0.5f,
-     0.5f, -0.5f,  0.5f,
-     0.5f, -0.5f,  0.5f,
-    -0.5f, -0.5f,  0.5f,
-    -0.5f, -0.5f, -0.5f,
-
-    -0.5f,  0.5f, -0.5f,
-     0.5f,  0.5f, -0.5f,
-     0.5f,  0.5f,  0.5f,
-     0.5f,  0.5f,  0.5f,
-    -0.5f,  0.5f,  0.5f,
-    -0.5f,  0.5f, -0.5f
-};
-
-unsigned int lamp_indices[] = {
-    0, 1, 3, // first triangle
-    1, 2, 3  // second triangle
-};
 
 Light::Light(std::string name,
              glm::vec3 scale_vec,
@@ -70,27 +20,10 @@ Light::Light(std::string name,
     this->default_ambient = default_ambient * 0.5f;
     this->name = std::move(name);
     this->shader = ShaderManager::get_shader_by_name("light");
+    this->model_location = shader->get_uniform_location("model");
 
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    // bind the Vertex Array Object first, then bind and set vertex buffer(s), and then configure vertex attributes(s).
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(lamp_vertices), lamp_vertices, GL_STATIC_DRAW);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(lamp_indices), lamp_indices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*) nullptr);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    glBindVertexArray(0);
-
-    shader->use();
-
-    glm::mat4 projection = glm::mat4(1.0f);
-    projection = glm::perspective(glm::radians(45.0f), 1280.0f / 720.0f, 0.1f, 100.0f);
+    // the lamp shader only reads the positions of the shared cube
+    this->mesh = MeshRegistry::acquire_cube();
 
     PointLightManager::add_point_light(new PointLight({this->name,
                                                        true,
@@ -101,15 +34,9 @@ Light::Light(std::string name,
                                                        1.0f,
                                                        0.35,
                                                        0.44}));
-
-    shader->setMat4("projection", projection);
 }
 
-void Light::draw() {
-    shader->use();
-    shader->setVec3("objectColor", 1.0f, 0.5f, 1.0f);
-    shader->setVec3("lightColor",  1.0f, 0.5f, 1.0f);
-
+glm::mat4 Light::get_model_matrix() const {
     // make sure to initialize matrix to identity matrix first
     glm::mat4 model = glm::mat4(1.0f);
 
@@ -117,14 +44,29 @@ void Light::draw() {
     model = glm::translate(model, translate_vec);
     model = glm::rotate(model, glm::radians(rotate_angle), rotate_vec);
     model = glm::scale(model, scale_vec);
+    return model;
+}
 
-    // retrieve the matrix uniform locations
-    // pass them to the shaders
-    shader->setMat4("view", Camera::instance->get_view_matrix());
-    shader->setMat4("model", model);
+AABB Light::get_bounds() const {
+    return mesh->bounds.transformed(get_model_matrix());
+}
 
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+void Light::draw() {
+    shader->use();
+    shader->setVec3("objectColor", 1.0f, 0.5f, 1.0f);
+    shader->setVec3("lightColor",  1.0f, 0.5f, 1.0f);
+
+    // view and projection come from the "Camera" uniform block
+    shader->setMat4(model_location, get_model_matrix());
+
+    glBindVertexArray(mesh->VAO);
+    glDrawElementsBaseVertex(GL_TRIANGLES, mesh->index_count, GL_UNSIGNED_INT,
+                             (void*)(mesh->first_index * sizeof(unsigned int)), mesh->base_vertex);
 
     glBindVertexArray(0);
+}
+
+void Light::free() {
+    MeshRegistry::release(mesh);
+    mesh = nullptr;
 }
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <numeric>
+
+#include "headers/MeshRegistry.h"
+#include "external/glfw-3.1.2/deps/glad/glad.h"
+
+// four vertices per face so every face keeps its own normal and texture coordinates
+static const float cube_vertices[] = {
+    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
+     0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 1.0f,
+
+    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
+     0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 0.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 1.0f,
+
+    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+    -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
+    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
+
+     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
+
+    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 0.0f,
+
+    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f,
+     0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 0.0f
+};
+
+static const unsigned int cube_indices[] = {
+    0, 1, 2,  2, 3, 0,
+    4, 5, 6,  6, 7, 4,
+    8, 9, 10,  10, 11, 8,
+    12, 13, 14,  14, 15, 12,
+    16, 17, 18,  18, 19, 16,
+    20, 21, 22,  22, 23, 20
+};
+
+std::unordered_map<std::string, Mesh*> MeshRegistry::meshes = {};
+unsigned int MeshRegistry::next_id = 0;
+unsigned int MeshRegistry::vertex_array = 0;
+unsigned int MeshRegistry::vertex_buffer = 0;
+unsigned int MeshRegistry::index_buffer = 0;
+unsigned int MeshRegistry::material_buffer = 0;
+int MeshRegistry::vertex_capacity = 0;
+int MeshRegistry::vertices_used = 0;
+int MeshRegistry::index_capacity = 0;
+int MeshRegistry::indices_used = 0;
+
+// a new buffer of size bytes starting with the used bytes of buffer, which is deleted
+static unsigned int grow_buffer(unsigned int buffer, size_t used, size_t size) {
+    unsigned int grown;
+    glGenBuffers(1, &grown);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+    if (buffer) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return grown;
+}
+
+void MeshRegistry::reserve(int vertex_count, int index_count) {
+    if (!vertex_array) {
+        glGenVertexArrays(1, &vertex_array);
+    }
+    glBindVertexArray(vertex_array);
+
+    if (vertices_used + vertex_count > vertex_capacity) {
+        int capacity = std::max(vertices_used + vertex_count, vertex_capacity * 2);
+        size_t vertex_size = MESH_VERTEX_STRIDE * sizeof(float);
+        vertex_buffer = grow_buffer(vertex_buffer, vertices_used * vertex_size, capacity * vertex_size);
+        vertex_capacity = capacity;
+
+        glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, MESH_VERTEX_STRIDE * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, MESH_VERTEX_STRIDE * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, MESH_VERTEX_STRIDE * sizeof(float), (void*)(6 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+
+        material_buffer = grow_buffer(material_buffer, vertices_used * sizeof(short), capacity * sizeof(short));
+        glBindBuffer(GL_ARRAY_BUFFER, material_buffer);
+        glVertexAttribIPointer(MESH_MATERIAL_LOCATION, 1, GL_SHORT, sizeof(short), (void*)0);
+        glEnableVertexAttribArray(MESH_MATERIAL_LOCATION);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // the element buffer binding is part of the vertex array
+    if (indices_used + index_count > index_capacity) {
+        int capacity = std::max(indices_used + index_count, index_capacity * 2);
+        index_buffer = grow_buffer(index_buffer, indices_used * sizeof(unsigned int), capacity * sizeof(unsigned int));
+        index_capacity = capacity;
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+    }
+
+    glBindVertexArray(0);
+}
+
+Mesh* MeshRegistry::acquire_existing(const std::string& name) {
+    auto it = meshes.find(name);
+    if (it == meshes.end()) {
+        return nullptr;
+    }
+    it->second->references++;
+    return it->second;
+}
+
+Mesh* MeshRegistry::acquire(const std::string& name, const float* vertices, int vertex_count,
+                            const unsigned int* indices, int index_count, const short* materials) {
+    if (Mesh* existing = acquire_existing(name)) {
+        return existing;
+    }
+
+    std::vector<unsigned int> triangle_list;
+    if (!indices) {
+        triangle_list.resize(vertex_count);
+        std::iota(triangle_list.begin(), triangle_list.end(), 0u);
+        indices = triangle_list.data();
+        index_count = vertex_count;
+    }
+    std::vector<short> no_materials;
+    if (!materials) {
+        no_materials.assign(vertex_count, NO_MATERIAL);
+        materials = no_materials.data();
+    }
+
+    reserve(vertex_count, index_count);
+    auto* mesh = new Mesh({name, next_id++, vertex_array, vertices_used, indices_used, vertex_count, index_count, 1,
+                           {glm::vec3(INFINITY), glm::vec3(-INFINITY)}, {}, {}});
+    mesh->vertices.assign(vertices, vertices + vertex_count * MESH_VERTEX_STRIDE);
+    mesh->indices.assign(indices, indices + index_count);
+    for (int i = 0; i < vertex_count; i++) {
+        glm::vec3 position(vertices[i * MESH_VERTEX_STRIDE],
+                           vertices[i * MESH_VERTEX_STRIDE + 1],
+                           vertices[i * MESH_VERTEX_STRIDE + 2]);
+        mesh->bounds.min = glm::min(mesh->bounds.min, position);
+        mesh->bounds.max = glm::max(mesh->bounds.max, position);
+    }
+
+    size_t vertex_size = MESH_VERTEX_STRIDE * sizeof(float);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vertex_buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, vertices_used * vertex_size, vertex_count * vertex_size, vertices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, material_buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, vertices_used * sizeof(short), vertex_count * sizeof(short), materials);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, index_buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, indices_used * sizeof(unsigned int), index_count * sizeof(unsigned int), indices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    vertices_used += vertex_count;
+    indices_used += index_count;
+
+    meshes[name] = mesh;
+    return mesh;
+}
+
+Mesh* MeshRegistry::acquire_cube() {
+    return acquire("cube", cube_vertices, sizeof(cube_vertices) / (MESH_VERTEX_STRIDE * sizeof(float)),
+                   cube_indices, sizeof(cube_indices) / sizeof(unsigned int));
+}
+
+void MeshRegistry::release(Mesh* mesh) {
+    if (--mesh->references > 0) {
+        return;
+    }
+    meshes.erase(mesh->name);
+    delete mesh;
+
+    if (meshes.empty()) {
+        glDeleteVertexArrays(1, &vertex_array);
+        glDeleteBuffers(1, &vertex_buffer);
+        glDeleteBuffers(1, &index_buffer);
+        glDeleteBuffers(1, &material_buffer);
+        vertex_array = vertex_buffer = index_buffer = material_buffer = 0;
+        vertex_capacity = vertices_used = index_capacity = indices_used = 0;
+    }
+}
+
+void MeshRegistry::discard_cpu_copies() {
+    for (auto& entry : meshes) {
+        entry.second->vertices.clear();
+        entry.second->vertices.shrink_to_fit();
+        entry.second->indices.clear();
+        entry.second->indices.shrink_to_fit();
+    }
+}
@@ -0,0 +1,89 @@
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include "headers/ModelLoader.h"
+
+Mesh* ModelLoader::acquire(const std::string& path) {
+    if (Mesh* mesh = MeshRegistry::acquire_existing(path)) {
+        return mesh;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    Assimp::Importer importer;
+    // the vertex layout only has room for positions, normals and one set of texture coordinates.
+    // Dropping the rest before welding lets more vertices merge
+    importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, aiComponent_COLORS | aiComponent_TANGENTS_AND_BITANGENTS
+                                                        | aiComponent_BONEWEIGHTS | aiComponent_ANIMATIONS
+                                                        | aiComponent_LIGHTS | aiComponent_CAMERAS);
+    // points and lines are left over after triangulation, they are dropped
+    importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
+
+    const aiScene* scene = importer.ReadFile(path, aiProcess_RemoveComponent
+                                                   | aiProcess_Triangulate
+                                                   | aiProcess_SortByPType
+                                                   | aiProcess_PreTransformVertices
+                                                   | aiProcess_GenSmoothNormals
+                                                   | aiProcess_JoinIdenticalVertices
+                                                   | aiProcess_ImproveCacheLocality);
+    if (!scene) {
+        std::cout << "Failed to import " << path << ": " << importer.GetErrorString() << std::endl;
+        return nullptr;
+    }
+
+    // PreTransformVertices moved every part into model space, they only need to be appended
+    size_t vertex_total = 0;
+    size_t index_total = 0;
+    for (unsigned int m = 0; m < scene->mNumMeshes; m++) {
+        vertex_total += scene->mMeshes[m]->mNumVertices;
+        index_total += scene->mMeshes[m]->mNumFaces * 3;
+    }
+
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    vertices.reserve(vertex_total * MESH_VERTEX_STRIDE);
+    indices.reserve(index_total);
+    for (unsigned int m = 0; m < scene->mNumMeshes; m++) {
+        const aiMesh* part = scene->mMeshes[m];
+        if (!(part->mPrimitiveTypes & aiPrimitiveType_TRIANGLE)) {
+            continue;
+        }
+
+        unsigned int base = static_cast<unsigned int>(vertices.size() / MESH_VERTEX_STRIDE);
+        for (unsigned int v = 0; v < part->mNumVertices; v++) {
+            const aiVector3D& position = part->mVertices[v];
+            aiVector3D normal = part->mNormals ? part->mNormals[v] : aiVector3D(0.0f, 1.0f, 0.0f);
+            aiVector3D uv = part->HasTextureCoords(0) ? part->mTextureCoords[0][v] : aiVector3D(0.0f);
+            vertices.insert(vertices.end(), {position.x, position.y, position.z,
+                                             normal.x, normal.y, normal.z,
+                                             uv.x, uv.y});
+        }
+        for (unsigned int f = 0; f < part->mNumFaces; f++) {
+            const aiFace& face = part->mFaces[f];
+            if (face.mNumIndices != 3) {
+                continue;
+            }
+            indices.push_back(base + face.mIndices[0]);
+            indices.push_back(base + face.mIndices[1]);
+            indices.push_back(base + face.mIndices[2]);
+        }
+    }
+
+    if (indices.empty()) {
+        std::cout << "Failed to import " << path << ": no triangles" << std::endl;
+        return nullptr;
+    }
+
+    int vertex_count = static_cast<int>(vertices.size() / MESH_VERTEX_STRIDE);
+    Mesh* mesh = MeshRegistry::acquire(path, vertices.data(), vertex_count, indices.data(), static_cast<int>(indices.size()));
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Model " << path << ": " << vertex_count << " vertices, " << indices.size() / 3
+              << " triangles in " << elapsed.count() << " ms" << std::endl;
+    return mesh;
+}
@@ -1,172 +1,107 @@
 #include <iostream>
-#include <filesystem>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "headers/Object.h"
 #include "headers/ShaderManager.h"
-#include "headers/Camera.h"
-#include "headers/PointLightManager.h"
-
-float obj_vertices[] = {
-    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
-     0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 0.0f,
-     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
-     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
-    -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 1.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
-
-    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
-     0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 0.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
-    -0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 1.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
-
-    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-    -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
-    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-    -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
-    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-
-     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-     0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
-     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-     0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
-     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-
-    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
-     0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 1.0f,
-     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
-     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 0.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
-
-    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f,
-     0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 1.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
-    -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 0.0f,
-    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
-};
-
-unsigned int obj_indices[] = {
-    0, 1, 3, // first triangle
-    1, 2, 3  // second triangle
-};
+#include "headers/TextureCache.h"
+#include "headers/ModelLoader.h"
 
 Object::Object(std::string name, glm::vec3 scale_vec, glm::vec3 rotate_vec, float rotate_angle, glm::vec3 translate_vec,
-               const char* texture_name) {
+               const char* texture_name, const char* model_path) {
     this->scale_vec = scale_vec;
     this->rotate_vec = rotate_vec;
     this->rotate_angle = rotate_angle;
     this->translate_vec = translate_vec;
+    this->transform_version = 0;
+    this->transform_dirty = true;
+    this->static_object = false;
+    this->material_array = 0;
     this->name = name;
     this->shader = ShaderManager::get_shader_by_name("texture");
     this->texture_name = texture_name;
 
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(obj_vertices), obj_vertices, GL_STATIC_DRAW);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(obj_indices), obj_indices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    load_texture();
-    shader->use();
-    glm::mat4 projection = glm::mat4(1.0f);
-    projection = glm::perspective(glm::radians(45.0f), 1280.0f / 720.0f, 0.1f, 100.0f);
+    this->mesh = model_path ? ModelLoader::acquire(model_path) : nullptr;
+    if (!this->mesh) {
+        this->mesh = MeshRegistry::acquire_cube();
+    }
 
-    shader->setMat4("projection", projection);
+    // camera, lights and the material are set on the shader once, see load_shaders()
+    this->texture = TextureCache::acquire(texture_name);
 }
 
-void Object::draw() {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    shader->use();
-
-    glm::mat4 model = glm::mat4(1.0f);
+Object::Object(std::string name, Mesh* mesh, const std::string& texture_name) {
+    this->scale_vec = glm::vec3(1.0f);
+    this->rotate_vec = glm::vec3(0.0f, 1.0f, 0.0f);
+    this->rotate_angle = 0.0f;
+    this->translate_vec = glm::vec3(0.0f);
+    this->transform_version = 0;
+    this->transform_dirty = true;
+    this->static_object = true;
+    this->material_array = 0;
+    this->name = name;
+    this->shader = ShaderManager::get_shader_by_name("texture");
+    this->texture_name = texture_name;
+    this->mesh = mesh;
+    this->texture = TextureCache::acquire(this->texture_name);
+}
 
-    model = glm::translate(model, translate_vec);
-    model = glm::rotate(model, glm::radians(rotate_angle), rotate_vec);
-    model = glm::scale(model, scale_vec);
+void Object::set_scale_vec(const glm::vec3& scale) {
+    scale_vec = scale;
+    transform_version++;
+    transform_dirty = true;
+}
 
-    light();
+void Object::set_rotation(float angle, const glm::vec3& axis) {
+    rotate_angle = angle;
+    rotate_vec = axis;
+    transform_version++;
+    transform_dirty = true;
+}
 
-    shader->setMat4("view", Camera::instance->get_view_matrix());
-    shader->setMat4("model", model);
+void Object::set_translate_vec(const glm::vec3& translation) {
+    translate_vec = translation;
+    transform_version++;
+    transform_dirty = true;
+}
 
-    if (Camera::instance->check_collision(this)) {
-        Camera::instance->colliding = this;
+const glm::mat4& Object::get_model_matrix() const {
+    if (transform_dirty) {
+        update_transform();
     }
-
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+    return model_matrix;
 }
 
-void Object::free() {
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
+const glm::mat3& Object::get_normal_matrix() const {
+    if (transform_dirty) {
+        update_transform();
+    }
+    return normal_matrix;
 }
 
-void Object::light() {
-    // directional light
-    shader->setVec3("dirLight.direction", -0.2f, -1.0f, -0.3f);
-    shader->setVec3("dirLight.ambient", 0.05f, 0.05f, 0.05f);
-    shader->setVec3("dirLight.diffuse", 0.1f, 0.1f, 0.1f);
-    shader->setVec3("dirLight.specular", 0.2f, 0.2f, 0.2f);
+const AABB& Object::get_bounds() const {
+    if (transform_dirty) {
+        update_transform();
+    }
+    return bounds;
+}
 
-    shader->setInt("material.diffuse", 0);
-    shader->setFloat("material.shininess", 32.0f);
+void Object::update_transform() const {
+    model_matrix = glm::mat4(1.0f);
 
-    std::vector<PointLight*> lights = PointLightManager::get_point_lights();
-    shader->setInt("pointLightsCount", static_cast<int>(lights.size()));
+    model_matrix = glm::translate(model_matrix, translate_vec);
+    model_matrix = glm::rotate(model_matrix, glm::radians(rotate_angle), rotate_vec);
+    model_matrix = glm::scale(model_matrix, scale_vec);
 
-    for (int i = 0; i < lights.size(); i++) {
-        shader->setInt("point_lights[" + std::to_string(i) + "].on", lights[i]->on);
-        shader->setVec3("point_lights[" + std::to_string(i) + "].position", lights[i]->position);
-        shader->setVec3("point_lights[" + std::to_string(i) + "].ambient", lights[i]->ambient);
-        shader->setVec3("point_lights[" + std::to_string(i) + "].diffuse", lights[i]->diffuse);
-        shader->setVec3("point_lights[" + std::to_string(i) + "].specular", lights[i]->specular);
-        shader->setFloat("point_lights[" + std::to_string(i) + "].constant", lights[i]->constant);
-        shader->setFloat("point_lights[" + std::to_string(i) + "].linear", lights[i]->linear);
-        shader->setFloat("point_lights[" + std::to_string(i) + "].quadratic", lights[i]->quadratic);
-    }
+    // normals need the inverse transpose so that non-uniform scaling doesn't skew them
+    normal_matrix = glm::mat3(glm::transpose(glm::inverse(model_matrix)));
+    bounds = mesh->bounds.transformed(model_matrix);
+    transform_dirty = false;
 }
 
-void Object::load_texture() {
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(texture_name, &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
-    {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    stbi_image_free(data);
-}
\ No newline at end of file
+void Object::free() {
+    MeshRegistry::release(mesh);
+    TextureCache::release(texture);
+    mesh = nullptr;
+    texture = nullptr;
+}
@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <iostream>
+
+#include "headers/PhysicsWorld.h"
+
+// iterations of the sweep and slide loop, each one removes the part of the motion into one surface
+const int MAX_SLIDE_ITERATIONS = 4;
+const int MAX_PENETRATION_ITERATIONS = 4;
+// gap kept between the capsule and the surface it slides along
+const float SKIN_WIDTH = 0.01f;
+
+btDefaultCollisionConfiguration* PhysicsWorld::configuration = nullptr;
+btCollisionDispatcher* PhysicsWorld::dispatcher = nullptr;
+btDbvtBroadphase* PhysicsWorld::broadphase = nullptr;
+btGhostPairCallback* PhysicsWorld::ghost_pair_callback = nullptr;
+btCollisionWorld* PhysicsWorld::world = nullptr;
+std::vector<PhysicsWorld::Body> PhysicsWorld::bodies;
+const std::vector<Object*>* PhysicsWorld::source = nullptr;
+btCapsuleShape* PhysicsWorld::character_shape = nullptr;
+btPairCachingGhostObject* PhysicsWorld::character = nullptr;
+
+static btVector3 to_bullet(const glm::vec3& v) {
+    return btVector3(v.x, v.y, v.z);
+}
+
+static glm::vec3 to_glm(const btVector3& v) {
+    return glm::vec3(v.x(), v.y(), v.z());
+}
+
+// closest hit of a sweep, ignoring the character itself and surfaces the motion leaves
+class CharacterSweepCallback : public btCollisionWorld::ClosestConvexResultCallback {
+private:
+    const btCollisionObject* self;
+    btVector3 motion;
+public:
+    CharacterSweepCallback(const btCollisionObject* self, const btVector3& from, const btVector3& to)
+        : btCollisionWorld::ClosestConvexResultCallback(from, to), self(self), motion(to - from) {}
+
+    btScalar addSingleResult(btCollisionWorld::LocalConvexResult& result, bool normal_in_world_space) override {
+        if (result.m_hitCollisionObject == self) {
+            return 1.0f;
+        }
+        btVector3 normal = normal_in_world_space
+                           ? result.m_hitNormalLocal
+                           : result.m_hitCollisionObject->getWorldTransform().getBasis() * result.m_hitNormalLocal;
+        if (normal.dot(motion) >= 0.0f) {
+            return 1.0f;
+        }
+        return btCollisionWorld::ClosestConvexResultCallback::addSingleResult(result, normal_in_world_space);
+    }
+};
+
+void PhysicsWorld::init() {
+    configuration = new btDefaultCollisionConfiguration();
+    dispatcher = new btCollisionDispatcher(configuration);
+    broadphase = new btDbvtBroadphase();
+    // keeps the character's own list of overlapping pairs up to date
+    ghost_pair_callback = new btGhostPairCallback();
+    broadphase->getOverlappingPairCache()->setInternalGhostPairCallback(ghost_pair_callback);
+    world = new btCollisionWorld(dispatcher, broadphase, configuration);
+}
+
+// box of the object's mesh bounds with the object's model matrix, split into the scale (applied to
+// the box) and a rigid transform
+void PhysicsWorld::place_body(Body& body) {
+    const glm::mat4& model = body.object->get_model_matrix();
+    const AABB& mesh_bounds = body.object->get_mesh()->bounds;
+
+    glm::vec3 scale(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])));
+    glm::vec3 half_extents = (mesh_bounds.max - mesh_bounds.min) * 0.5f * scale;
+    glm::vec3 center = glm::vec3(model * glm::vec4(mesh_bounds.get_center(), 1.0f));
+
+    btMatrix3x3 basis;
+    for (int column = 0; column < 3; column++) {
+        glm::vec3 axis = scale[column] > 0.0f ? glm::vec3(model[column]) / scale[column] : glm::vec3(0.0f);
+        basis[0][column] = axis.x;
+        basis[1][column] = axis.y;
+        basis[2][column] = axis.z;
+    }
+
+    delete body.shape;
+    body.shape = new btBoxShape(to_bullet(half_extents));
+    // the margin lies inside the box, thin objects like the screen need a smaller one
+    float thinnest = std::min(half_extents.x, std::min(half_extents.y, half_extents.z));
+    body.shape->setMargin(std::min(body.shape->getMargin(), thinnest * 0.5f));
+
+    body.collision_object->setCollisionShape(body.shape);
+    body.collision_object->setWorldTransform(btTransform(basis, to_bullet(center)));
+    body.version = body.object->get_transform_version();
+}
+
+void PhysicsWorld::add_body(Body& body) {
+    place_body(body);
+    // static boxes only need pairs with the character, not with each other
+    world->addCollisionObject(body.collision_object, btBroadphaseProxy::StaticFilter,
+                              btBroadphaseProxy::AllFilter ^ btBroadphaseProxy::StaticFilter);
+}
+
+void PhysicsWorld::clear_bodies() {
+    for (Body& body : bodies) {
+        world->removeCollisionObject(body.collision_object);
+        delete body.collision_object;
+        delete body.shape;
+    }
+    bodies.clear();
+}
+
+void PhysicsWorld::build(const std::vector<Object*>& objects) {
+    source = &objects;
+    clear_bodies();
+    bodies.reserve(objects.size());
+    for (Object* object : objects) {
+        Body body = {object, 0, new btCollisionObject(), nullptr};
+        body.collision_object->setCollisionFlags(btCollisionObject::CF_STATIC_OBJECT);
+        body.collision_object->setUserPointer(object);
+        add_body(body);
+        bodies.push_back(body);
+    }
+}
+
+void PhysicsWorld::update() {
+    if (!source) {
+        return;
+    }
+    if (source->size() != bodies.size()) {
+        build(*source);
+        return;
+    }
+
+    for (Body& body : bodies) {
+        if (body.object->get_transform_version() != body.version) {
+            // re-adding drops the contacts that were computed for the old shape
+            world->removeCollisionObject(body.collision_object);
+            add_body(body);
+        }
+    }
+}
+
+void PhysicsWorld::create_character(const glm::vec3& size, const glm::vec3& position) {
+    float radius = std::max(size.x, size.z) * 0.5f;
+    character_shape = new btCapsuleShape(radius, std::max(size.y - 2.0f * radius, 0.0f));
+
+    character = new btPairCachingGhostObject();
+    character->setCollisionShape(character_shape);
+    character->setCollisionFlags(btCollisionObject::CF_CHARACTER_OBJECT);
+    character->setWorldTransform(btTransform(btQuaternion::getIdentity(), to_bullet(position)));
+    world->addCollisionObject(character, btBroadphaseProxy::CharacterFilter,
+                              btBroadphaseProxy::StaticFilter | btBroadphaseProxy::DefaultFilter);
+}
+
+// pushes the character out of the boxes it overlaps, a step at a time along the contact normals.
+// Returns true if it still overlapped something
+bool PhysicsWorld::recover_from_penetration() {
+    world->updateSingleAabb(character);
+    broadphase->calculateOverlappingPairs(dispatcher);
+    dispatcher->dispatchAllCollisionPairs(character->getOverlappingPairCache(), world->getDispatchInfo(), dispatcher);
+
+    btVector3 position = character->getWorldTransform().getOrigin();
+    bool penetrating = false;
+    btManifoldArray manifolds;
+    btBroadphasePairArray& pairs = character->getOverlappingPairCache()->getOverlappingPairArray();
+    for (int i = 0; i < pairs.size(); i++) {
+        manifolds.resize(0);
+        if (pairs[i].m_algorithm) {
+            pairs[i].m_algorithm->getAllContactManifolds(manifolds);
+        }
+        for (int j = 0; j < manifolds.size(); j++) {
+            const btPersistentManifold* manifold = manifolds[j];
+            float sign = manifold->getBody0() == character ? -1.0f : 1.0f;
+            for (int p = 0; p < manifold->getNumContacts(); p++) {
+                const btManifoldPoint& point = manifold->getContactPoint(p);
+                if (point.getDistance() < 0.0f) {
+                    position += point.m_normalWorldOnB * sign * point.getDistance() * 0.2f;
+                    penetrating = true;
+                }
+            }
+        }
+    }
+
+    character->getWorldTransform().setOrigin(position);
+    return penetrating;
+}
+
+btVector3 PhysicsWorld::sweep(const btVector3& from, const btVector3& to) {
+    btVector3 current = from;
+    btVector3 target = to;
+    for (int i = 0; i < MAX_SLIDE_ITERATIONS; i++) {
+        btVector3 motion = target - current;
+        float distance = motion.length();
+        if (distance < SIMD_EPSILON) {
+            break;
+        }
+
+        CharacterSweepCallback callback(character, current, target);
+        world->convexSweepTest(character_shape,
+                               btTransform(btQuaternion::getIdentity(), current),
+                               btTransform(btQuaternion::getIdentity(), target),
+                               callback, world->getDispatchInfo().m_allowedCcdPenetration);
+        if (!callback.hasHit()) {
+            current = target;
+            break;
+        }
+
+        // up to the surface, then along it with whatever is left of the motion
+        float travel = std::max(callback.m_closestHitFraction * distance - SKIN_WIDTH, 0.0f);
+        current += motion * (travel / distance);
+        btVector3 normal = callback.m_hitNormalWorld.normalized();
+        btVector3 remaining = target - current;
+        target = current + remaining - normal * remaining.dot(normal);
+    }
+    return current;
+}
+
+glm::vec3 PhysicsWorld::move_character(const glm::vec3& from, const glm::vec3& to) {
+    if (!character) {
+        return to;
+    }
+
+    character->getWorldTransform().setOrigin(to_bullet(from));
+    for (int i = 0; i < MAX_PENETRATION_ITERATIONS && recover_from_penetration(); i++) {
+    }
+
+    btVector3 start = character->getWorldTransform().getOrigin();
+    btVector3 end = sweep(start, start + to_bullet(to - from));
+    character->getWorldTransform().setOrigin(end);
+    world->updateSingleAabb(character);
+    return to_glm(end);
+}
+
+void PhysicsWorld::free() {
+    if (!world) {
+        return;
+    }
+
+    clear_bodies();
+    source = nullptr;
+    if (character) {
+        world->removeCollisionObject(character);
+        delete character;
+        delete character_shape;
+        character = nullptr;
+        character_shape = nullptr;
+    }
+
+    delete world;
+    delete ghost_pair_callback;
+    delete broadphase;
+    delete dispatcher;
+    delete configuration;
+    world = nullptr;
+}
@@ -1,3 +1,144 @@
 #include "headers/PointLightManager.h"
+#include "external/glfw-3.1.2/deps/glad/glad.h"
 
-std::vector<PointLight*> PointLightManager::point_lights = {};
\ No newline at end of file
+#include <algorithm>
+#include <cmath>
+
+// std140 layout of the "Lights" block, vec3 members are padded to 16 bytes
+struct DirLightStd140 {
+    glm::vec4 direction;
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+};
+
+struct LightsBlockStd140 {
+    DirLightStd140 dir_light;
+};
+
+// four RGBA32F texels per light in the "pointLightData" texture buffer
+struct PointLightTexels {
+    glm::vec3 position;
+    float constant;
+    glm::vec3 ambient;
+    float linear;
+    glm::vec3 diffuse;
+    float quadratic;
+    glm::vec3 specular;
+    float radius;
+};
+
+static_assert(sizeof(PointLightTexels) == 64, "PointLight must span four RGBA32F texels");
+
+std::vector<PointLight*> PointLightManager::point_lights = {};
+DirLight PointLightManager::directional_light = {};
+unsigned int PointLightManager::ubo = 0;
+unsigned int PointLightManager::light_buffer = 0;
+unsigned int PointLightManager::light_texture = 0;
+float PointLightManager::light_cutoff = DEFAULT_LIGHT_CUTOFF;
+std::vector<float> PointLightManager::light_radii = {};
+unsigned int PointLightManager::version = 0;
+bool PointLightManager::dirty = true;
+
+static float get_brightest(const PointLight& light) {
+    return std::max({light.ambient.r, light.ambient.g, light.ambient.b,
+                     light.diffuse.r, light.diffuse.g, light.diffuse.b,
+                     light.specular.r, light.specular.g, light.specular.b});
+}
+
+float PointLightManager::get_light_radius(const PointLight& light) {
+    // solve constant + linear * d + quadratic * d^2 = brightest / cutoff for d
+    float c = light.constant - get_brightest(light) / light_cutoff;
+    if (c >= 0.0f) {
+        return 0.0f;
+    }
+    if (light.quadratic <= 0.0f) {
+        return light.linear > 0.0f ? -c / light.linear : MAX_LIGHT_RADIUS;
+    }
+    float radius = (-light.linear + std::sqrt(light.linear * light.linear - 4.0f * light.quadratic * c)) / (2.0f * light.quadratic);
+    return std::min(radius, MAX_LIGHT_RADIUS);
+}
+
+int PointLightManager::find_relevant_lights(const AABB& bounds, int* indices) {
+    static std::vector<std::pair<float, int>> candidates; // brightness at the closest point, index
+    candidates.clear();
+
+    int count = std::min(static_cast<int>(light_radii.size()), MAX_POINT_LIGHTS);
+    for (int i = 0; i < count; i++) {
+        const PointLight& light = *point_lights[i];
+        if (!light.on) {
+            continue;
+        }
+        float radius = light_radii[i];
+        float distance_squared = bounds.distance_squared(light.position);
+        if (distance_squared > radius * radius) {
+            continue;
+        }
+        float distance = std::sqrt(distance_squared);
+        float brightness = get_brightest(light) / (light.constant + light.linear * distance + light.quadratic * distance_squared);
+        candidates.emplace_back(brightness, i);
+    }
+
+    int found = std::min(static_cast<int>(candidates.size()), MAX_OBJECT_LIGHTS);
+    std::partial_sort(candidates.begin(), candidates.begin() + found, candidates.end(),
+                      [](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.first > b.first; });
+    for (int i = 0; i < MAX_OBJECT_LIGHTS; i++) {
+        indices[i] = i < found ? candidates[i].second : -1;
+    }
+    return found;
+}
+
+void PointLightManager::upload() {
+    if (!ubo) {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(LightsBlockStd140), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, LIGHTS_BLOCK_BINDING, ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        glGenBuffers(1, &light_buffer);
+        glGenTextures(1, &light_texture);
+        glBindBuffer(GL_TEXTURE_BUFFER, light_buffer);
+        glBufferData(GL_TEXTURE_BUFFER, MAX_POINT_LIGHTS * sizeof(PointLightTexels), nullptr, GL_DYNAMIC_DRAW);
+        glActiveTexture(GL_TEXTURE0 + LIGHT_DATA_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_BUFFER, light_texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, light_buffer);
+        glActiveTexture(GL_TEXTURE0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        dirty = true;
+    }
+    if (!dirty) {
+        return;
+    }
+
+    LightsBlockStd140 block;
+    block.dir_light = {glm::vec4(directional_light.direction, 0.0f),
+                       glm::vec4(directional_light.ambient, 0.0f),
+                       glm::vec4(directional_light.diffuse, 0.0f),
+                       glm::vec4(directional_light.specular, 0.0f)};
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightsBlockStd140), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    static std::vector<PointLightTexels> texels;
+    int count = std::min(static_cast<int>(point_lights.size()), MAX_POINT_LIGHTS);
+    texels.resize(count);
+    light_radii.resize(count);
+    for (int i = 0; i < count; i++) {
+        const PointLight* light = point_lights[i];
+        light_radii[i] = get_light_radius(*light);
+        texels[i] = {light->position, light->constant,
+                     light->ambient, light->linear,
+                     light->diffuse, light->quadratic,
+                     light->specular, light_radii[i]};
+    }
+
+    // only the lights in use have to reach the GPU
+    if (count > 0) {
+        glBindBuffer(GL_TEXTURE_BUFFER, light_buffer);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, count * sizeof(PointLightTexels), texels.data());
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+    version++;
+    dirty = false;
+}
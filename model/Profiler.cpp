@@ -0,0 +1,165 @@
+#include <fstream>
+#include <iostream>
+
+#include "headers/Profiler.h"
+#include "headers/GLExtensions.h"
+
+std::vector<ProfileEvent> Profiler::events;
+std::vector<int> Profiler::open_scopes;
+std::vector<unsigned int> Profiler::free_queries;
+size_t Profiler::first_pending = 0;
+std::chrono::steady_clock::time_point Profiler::epoch;
+std::string Profiler::trace_path;
+int Profiler::first_frame = 0;
+int Profiler::last_frame = -1;
+int Profiler::frame = -1;
+bool Profiler::written = false;
+
+void Profiler::capture(int first, int last, const std::string& path) {
+    first_frame = first;
+    last_frame = last;
+    trace_path = path;
+    written = false;
+}
+
+bool Profiler::capturing() {
+    return !trace_path.empty() && frame >= first_frame && frame <= last_frame;
+}
+
+double Profiler::now() {
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - epoch;
+    return elapsed.count();
+}
+
+void Profiler::begin_frame() {
+    resolve_queries();
+    frame++;
+    if (frame == first_frame) {
+        epoch = std::chrono::steady_clock::now();
+    }
+    begin_scope("frame");
+}
+
+void Profiler::end_frame() {
+    end_scope();
+    resolve_queries();
+}
+
+void Profiler::begin_scope(const char* name) {
+    if (!capturing()) {
+        return;
+    }
+
+    ProfileEvent event = {name, frame, (int) open_scopes.size(), now(), 0, -1, 0};
+    // depth 0 is the frame itself, its direct children are the outermost scopes
+    if (event.depth == 1 && glGetQueryObjectui64v) {
+        if (free_queries.empty()) {
+            glGenQueries(1, &event.query);
+        }
+        else {
+            event.query = free_queries.back();
+            free_queries.pop_back();
+        }
+        glBeginQuery(GL_TIME_ELAPSED, event.query);
+    }
+
+    open_scopes.push_back((int) events.size());
+    events.push_back(event);
+}
+
+void Profiler::end_scope() {
+    if (open_scopes.empty()) {
+        return;
+    }
+
+    ProfileEvent& event = events[open_scopes.back()];
+    if (event.query) {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+    event.cpu_duration = now() - event.cpu_start;
+    open_scopes.pop_back();
+}
+
+// reads back the queries that finished, in issue order, without stalling on the first one that didn't
+void Profiler::resolve_queries() {
+    if (!open_scopes.empty()) {
+        return;
+    }
+
+    while (first_pending < events.size()) {
+        ProfileEvent& event = events[first_pending];
+        if (event.query) {
+            GLint available = 0;
+            glGetQueryObjectiv(event.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) {
+                break;
+            }
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(event.query, GL_QUERY_RESULT, &nanoseconds);
+            event.gpu_duration = nanoseconds / 1000.0;
+            free_queries.push_back(event.query);
+            event.query = 0;
+        }
+        first_pending++;
+    }
+
+    if (!written && frame >= last_frame && first_pending == events.size() && !events.empty()) {
+        write_trace();
+    }
+}
+
+// Chrome trace event format, opens in chrome://tracing or Perfetto. GPU scopes are placed at the
+// time their commands were issued on the CPU, their length is the measured GPU time.
+void Profiler::write_trace() {
+    written = true;
+
+    std::ofstream file(trace_path);
+    if (!file) {
+        std::cout << "Failed to write the profiler trace to " << trace_path << std::endl;
+        return;
+    }
+
+    file << "{\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+    for (const ProfileEvent& event : events) {
+        file << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+             << ",\"ts\":" << event.cpu_start << ",\"dur\":" << event.cpu_duration
+             << ",\"args\":{\"frame\":" << event.frame << "}}";
+        if (event.gpu_duration >= 0) {
+            file << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":1,\"tid\":2"
+                 << ",\"ts\":" << event.cpu_start << ",\"dur\":" << event.gpu_duration
+                 << ",\"args\":{\"frame\":" << event.frame << "}}";
+        }
+    }
+    file << "\n]}\n";
+
+    int last = events.back().frame;
+    std::cout << "Profiler: wrote frames " << first_frame << "-" << last << " to " << trace_path << std::endl;
+}
+
+void Profiler::shutdown() {
+    while (!open_scopes.empty()) {
+        end_scope();
+    }
+
+    // the range was cut short, wait for whatever is still in flight
+    for (; first_pending < events.size(); first_pending++) {
+        ProfileEvent& event = events[first_pending];
+        if (event.query) {
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(event.query, GL_QUERY_RESULT, &nanoseconds);
+            event.gpu_duration = nanoseconds / 1000.0;
+            free_queries.push_back(event.query);
+            event.query = 0;
+        }
+    }
+    if (!written && !events.empty()) {
+        write_trace();
+    }
+
+    if (!free_queries.empty()) {
+        glDeleteQueries((GLsizei) free_queries.size(), free_queries.data());
+        free_queries.clear();
+    }
+}
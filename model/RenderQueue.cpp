@@ -0,0 +1,49 @@
+#include <algorithm>
+
+#include "headers/RenderQueue.h"
+
+uint64_t RenderQueue::make_key(unsigned int shader, unsigned int texture, unsigned int mesh, float depth) {
+    // front to back inside a state group, so early depth testing rejects hidden fragments
+    auto quantized_depth = static_cast<uint64_t>(std::clamp(depth, 0.0f, 1.0f) * 0xFFFFFF);
+
+    return (static_cast<uint64_t>(shader & 0xFF) << 56)
+         | (static_cast<uint64_t>(texture & 0xFFFF) << 40)
+         | (static_cast<uint64_t>(mesh & 0xFFFF) << 24)
+         | quantized_depth;
+}
+
+void RenderQueue::push(Object* object, const glm::mat4& view) {
+    // the center of the world box, static batches are untransformed and sit at the origin
+    glm::vec4 view_position = view * glm::vec4(object->get_bounds().get_center(), 1.0f);
+    float depth = -view_position.z / far_plane;
+
+    items.push_back({make_key(object->get_shader()->ID, object->get_texture(), object->get_mesh()->id, depth), object});
+}
+
+void RenderQueue::sort() {
+    if (items.empty()) {
+        return;
+    }
+    scratch.resize(items.size());
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t counts[256] = {};
+        for (const DrawItem& item : items) {
+            counts[(item.key >> shift) & 0xFF]++;
+        }
+        if (counts[(items[0].key >> shift) & 0xFF] == items.size()) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t& count : counts) {
+            size_t bucket = count;
+            count = offset;
+            offset += bucket;
+        }
+        for (const DrawItem& item : items) {
+            scratch[counts[(item.key >> shift) & 0xFF]++] = item;
+        }
+        items.swap(scratch);
+    }
+}
@@ -0,0 +1,254 @@
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "headers/SceneFile.h"
+#include "headers/MappedFile.h"
+
+const char SCENE_MAGIC[4] = {'S', 'C', 'N', 'B'};
+const uint32_t SCENE_VERSION = 3;
+
+struct SceneHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t object_count;
+    uint32_t light_count;
+    uint32_t has_directional_light;
+    DirLight directional_light;
+    uint32_t strings_size;
+};
+
+// the records are read straight out of the mapping, so the layout must not depend on the compiler
+static_assert(sizeof(SceneHeader) == 72, "unexpected padding in SceneHeader");
+static_assert(sizeof(SceneFile::ObjectRecord) == 56, "unexpected padding in ObjectRecord");
+static_assert(sizeof(SceneFile::LightRecord) == 56, "unexpected padding in LightRecord");
+
+static uint32_t add_string(std::string& strings, const std::string& value) {
+    uint32_t offset = static_cast<uint32_t>(strings.size());
+    strings += value;
+    strings += '\0';
+    return offset;
+}
+
+bool SceneFile::parse_text(const std::string& path, Scene& scene) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "Failed to open the scene file " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string type;
+        if (!(fields >> type)) {
+            continue;
+        }
+        bool is_static = type == "static";
+        if (is_static && !(fields >> type && (type == "object" || type == "model"))) {
+            std::cout << path << ":" << line_number << ": static needs an object or model entry" << std::endl;
+            return false;
+        }
+
+        bool valid;
+        if (type == "object" || type == "model") {
+            std::string name, model, texture;
+            ObjectRecord record = {};
+            fields >> name;
+            if (type == "model") {
+                fields >> model;
+            }
+            valid = static_cast<bool>(fields >> texture
+                >> record.scale.x >> record.scale.y >> record.scale.z
+                >> record.rotation_axis.x >> record.rotation_axis.y >> record.rotation_axis.z
+                >> record.rotation_angle
+                >> record.translation.x >> record.translation.y >> record.translation.z);
+            record.name = add_string(scene.strings, name);
+            record.texture = add_string(scene.strings, texture);
+            record.model = type == "model" ? add_string(scene.strings, model) : NO_MODEL;
+            record.flags = is_static ? STATIC_OBJECT : 0;
+            scene.objects.push_back(record);
+        }
+        else if (type == "light") {
+            std::string name;
+            LightRecord record = {};
+            valid = static_cast<bool>(fields >> name
+                >> record.scale.x >> record.scale.y >> record.scale.z
+                >> record.rotation_axis.x >> record.rotation_axis.y >> record.rotation_axis.z
+                >> record.ambient.x >> record.ambient.y >> record.ambient.z
+                >> record.rotation_angle
+                >> record.translation.x >> record.translation.y >> record.translation.z);
+            record.name = add_string(scene.strings, name);
+            scene.lights.push_back(record);
+        }
+        else if (type == "directional") {
+            DirLight& light = scene.directional_light;
+            valid = static_cast<bool>(fields
+                >> light.direction.x >> light.direction.y >> light.direction.z
+                >> light.ambient.x >> light.ambient.y >> light.ambient.z
+                >> light.diffuse.x >> light.diffuse.y >> light.diffuse.z
+                >> light.specular.x >> light.specular.y >> light.specular.z);
+            scene.has_directional_light = true;
+        }
+        else {
+            std::cout << path << ":" << line_number << ": unknown entry '" << type << "'" << std::endl;
+            return false;
+        }
+
+        std::string extra;
+        if (!valid || fields >> extra) {
+            std::cout << path << ":" << line_number << ": malformed " << type << " entry" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SceneFile::instantiate(const ObjectRecord* objects, uint32_t object_count,
+                            const LightRecord* lights, uint32_t light_count,
+                            const DirLight* directional_light,
+                            const char* strings, size_t strings_size,
+                            std::vector<Object*>& room_objects, std::vector<Light*>& light_objects) {
+    // every offset has to start a string inside the table, the table ends with a terminator
+    if (strings_size == 0 || strings[strings_size - 1] != '\0') {
+        std::cout << "Scene string table is not terminated" << std::endl;
+        return false;
+    }
+    for (uint32_t i = 0; i < object_count; i++) {
+        if (objects[i].name >= strings_size || objects[i].texture >= strings_size
+            || (objects[i].model != NO_MODEL && objects[i].model >= strings_size)) {
+            std::cout << "Scene object " << i << " points outside the string table" << std::endl;
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < light_count; i++) {
+        if (lights[i].name >= strings_size) {
+            std::cout << "Scene light " << i << " points outside the string table" << std::endl;
+            return false;
+        }
+    }
+
+    room_objects.reserve(room_objects.size() + object_count);
+    for (uint32_t i = 0; i < object_count; i++) {
+        const ObjectRecord& record = objects[i];
+        auto* object = new Object(strings + record.name,
+                                  record.scale,
+                                  record.rotation_axis,
+                                  record.rotation_angle,
+                                  record.translation,
+                                  strings + record.texture,
+                                  record.model != NO_MODEL ? strings + record.model : nullptr);
+        object->set_static((record.flags & STATIC_OBJECT) != 0);
+        room_objects.push_back(object);
+    }
+
+    light_objects.reserve(light_objects.size() + light_count);
+    for (uint32_t i = 0; i < light_count; i++) {
+        const LightRecord& record = lights[i];
+        light_objects.push_back(new Light(strings + record.name,
+                                          record.scale,
+                                          record.rotation_axis,
+                                          record.ambient,
+                                          record.rotation_angle,
+                                          record.translation));
+    }
+
+    if (directional_light) {
+        PointLightManager::set_directional_light(*directional_light);
+    }
+    return true;
+}
+
+bool SceneFile::load(const std::string& path, std::vector<Object*>& objects, std::vector<Light*>& lights) {
+    auto start = std::chrono::steady_clock::now();
+
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+
+    bool loaded;
+    uint32_t object_count, light_count;
+    if (file.get_size() < sizeof(SceneHeader) || std::memcmp(file.get_data(), SCENE_MAGIC, sizeof(SCENE_MAGIC)) != 0) {
+        file.close();
+        Scene scene;
+        if (!parse_text(path, scene)) {
+            return false;
+        }
+        object_count = static_cast<uint32_t>(scene.objects.size());
+        light_count = static_cast<uint32_t>(scene.lights.size());
+        // a scene without names still needs a terminated table
+        scene.strings += '\0';
+        loaded = instantiate(scene.objects.data(), object_count, scene.lights.data(), light_count,
+                             scene.has_directional_light ? &scene.directional_light : nullptr,
+                             scene.strings.data(), scene.strings.size(), objects, lights);
+    }
+    else {
+        const char* data = file.get_data();
+        const SceneHeader* header = reinterpret_cast<const SceneHeader*>(data);
+        object_count = header->object_count;
+        light_count = header->light_count;
+        size_t objects_offset = sizeof(SceneHeader);
+        size_t lights_offset = objects_offset + (size_t) object_count * sizeof(ObjectRecord);
+        size_t strings_offset = lights_offset + (size_t) light_count * sizeof(LightRecord);
+        if (header->version != SCENE_VERSION) {
+            std::cout << path << ": scene version " << header->version << ", expected " << SCENE_VERSION << std::endl;
+            return false;
+        }
+        if (strings_offset + header->strings_size != file.get_size()) {
+            std::cout << path << ": truncated scene file" << std::endl;
+            return false;
+        }
+        loaded = instantiate(reinterpret_cast<const ObjectRecord*>(data + objects_offset), object_count,
+                             reinterpret_cast<const LightRecord*>(data + lights_offset), light_count,
+                             header->has_directional_light ? &header->directional_light : nullptr,
+                             data + strings_offset, header->strings_size, objects, lights);
+    }
+
+    if (loaded) {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Scene " << path << ": " << object_count << " objects, " << light_count
+                  << " lights in " << elapsed.count() << " ms" << std::endl;
+    }
+    return loaded;
+}
+
+bool SceneFile::compile(const std::string& text_path, const std::string& binary_path) {
+    Scene scene;
+    if (!parse_text(text_path, scene)) {
+        return false;
+    }
+    scene.strings += '\0';
+
+    SceneHeader header = {};
+    std::memcpy(header.magic, SCENE_MAGIC, sizeof(SCENE_MAGIC));
+    header.version = SCENE_VERSION;
+    header.object_count = static_cast<uint32_t>(scene.objects.size());
+    header.light_count = static_cast<uint32_t>(scene.lights.size());
+    header.has_directional_light = scene.has_directional_light ? 1 : 0;
+    header.directional_light = scene.directional_light;
+    header.strings_size = static_cast<uint32_t>(scene.strings.size());
+
+    std::ofstream file(binary_path, std::ios::binary);
+    if (!file) {
+        std::cout << "Failed to write the scene file " << binary_path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(scene.objects.data()), scene.objects.size() * sizeof(ObjectRecord));
+    file.write(reinterpret_cast<const char*>(scene.lights.data()), scene.lights.size() * sizeof(LightRecord));
+    file.write(scene.strings.data(), scene.strings.size());
+    if (!file) {
+        std::cout << "Failed to write the scene file " << binary_path << std::endl;
+        return false;
+    }
+
+    std::cout << "Compiled " << text_path << " to " << binary_path << ": " << header.object_count << " objects, "
+              << header.light_count << " lights" << std::endl;
+    return true;
+}
@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <utility>
+
+#include "headers/StaticBatcher.h"
+#include "headers/GLExtensions.h"
+
+std::vector<Object*> StaticBatcher::batches = {};
+std::vector<StaticBatcher::MaterialArray> StaticBatcher::arrays = {};
+unsigned int StaticBatcher::placeholder = 0;
+
+static bool is_compressed(unsigned int format) {
+    return format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+}
+
+// client format of the uncompressed layouts TextureCache uploads
+static GLenum pixel_format(unsigned int format) {
+    return format == GL_RGBA8 ? GL_RGBA : GL_RGB;
+}
+
+// bytes of one layer of a mip level
+static size_t level_size(unsigned int format, int width, int height) {
+    auto blocks = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+    switch (format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: return blocks * 8;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return blocks * 16;
+        case GL_RGBA8: return static_cast<size_t>(width) * height * 4;
+        default: return static_cast<size_t>(width) * height * 3;
+    }
+}
+
+static const char* format_name(unsigned int format) {
+    switch (format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: return "BC1";
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return "BC3";
+        case GL_RGBA8: return "RGBA8";
+        default: return "RGB8";
+    }
+}
+
+void StaticBatcher::build(const std::vector<Object*>& objects, std::vector<Object*>& render_objects) {
+    // ordered, so the batches come out the same on every run
+    std::map<std::pair<unsigned int, TextureLayout>, std::vector<Object*>> groups;
+    std::map<std::string, bool> probed; // texture path, readable
+    std::map<std::string, TextureLayout> layouts;
+    for (Object* object : objects) {
+        if (!object->is_static()) {
+            render_objects.push_back(object);
+            continue;
+        }
+        const std::string& path = object->get_texture_name();
+        auto it = probed.find(path);
+        if (it == probed.end()) {
+            it = probed.emplace(path, TextureCache::probe(path, layouts[path])).first;
+        }
+        if (it->second) {
+            groups[{object->get_shader()->ID, layouts[path]}].push_back(object);
+        }
+        else {
+            render_objects.push_back(object);
+        }
+    }
+
+    size_t batched_objects = 0;
+    for (const auto& group : groups) {
+        // one layer per distinct texture, in order of first use
+        std::vector<const Object*> layer_sources;
+        std::vector<Object*> members;
+        std::vector<short> member_layers;
+        for (Object* object : group.second) {
+            auto layer = std::find_if(layer_sources.begin(), layer_sources.end(),
+                                      [object](const Object* source) { return source->get_texture() == object->get_texture(); });
+            if (layer == layer_sources.end()) {
+                if (layer_sources.size() == MAX_STATIC_MATERIALS) {
+                    render_objects.push_back(object);
+                    continue;
+                }
+                layer = layer_sources.insert(layer_sources.end(), object);
+            }
+            members.push_back(object);
+            member_layers.push_back(static_cast<short>(layer - layer_sources.begin()));
+        }
+
+        if (members.size() == 1) {
+            render_objects.push_back(members.front());
+            continue;
+        }
+        if (layer_sources.size() == 1) {
+            std::fill(member_layers.begin(), member_layers.end(), NO_MATERIAL);
+        }
+        Object* batch = merge(members, member_layers);
+        batches.push_back(batch);
+        render_objects.push_back(batch);
+        batched_objects += members.size();
+        if (layer_sources.size() == 1) {
+            continue;
+        }
+
+        MaterialArray array = {group.first.second, {}, batch, 0};
+        for (const Object* source : layer_sources) {
+            // a reference of our own, the layers are filled long after the objects may have let go
+            array.layers.push_back(TextureCache::acquire(source->get_texture_name()));
+        }
+        arrays.push_back(array);
+    }
+
+    if (!batches.empty()) {
+        std::cout << "Static batching: " << batched_objects << " objects in " << batches.size() << " batches" << std::endl;
+    }
+    if (arrays.empty()) {
+        return;
+    }
+
+    size_t total_size = 0;
+    for (const MaterialArray& array : arrays) {
+        const TextureLayout& layout = array.layout;
+        size_t size = 0;
+        for (int level = 0; level < layout.levels; level++) {
+            size += level_size(layout.format, std::max(1, layout.width >> level), std::max(1, layout.height >> level));
+        }
+        size *= array.layers.size();
+        total_size += size;
+        std::cout << "Static material array: " << array.layers.size() << " layers of " << layout.width << "x"
+                  << layout.height << " " << format_name(layout.format) << ", " << layout.levels << " mips, "
+                  << size / 1024 << " KB" << std::endl;
+    }
+    std::cout << "Static material arrays: " << total_size / 1024 << " KB" << std::endl;
+
+    // grey, like the placeholder of each texture, until update() fills an array
+    const unsigned char grey[4] = {128, 128, 128, 255};
+    glGenTextures(1, &placeholder);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, placeholder);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    // the layer coordinate is clamped, one layer serves every batch
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, 1, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    for (const MaterialArray& array : arrays) {
+        array.batch->set_material_array(placeholder);
+    }
+}
+
+Object* StaticBatcher::merge(const std::vector<Object*>& group, const std::vector<short>& group_layers) {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<short> vertex_materials;
+    for (size_t i = 0; i < group.size(); i++) {
+        const Mesh* mesh = group[i]->get_mesh();
+        const glm::mat4& model = group[i]->get_model_matrix();
+        const glm::mat3& normal_matrix = group[i]->get_normal_matrix();
+        auto base = static_cast<unsigned int>(vertices.size() / MESH_VERTEX_STRIDE);
+
+        for (int v = 0; v < mesh->vertex_count; v++) {
+            const float* vertex = &mesh->vertices[v * MESH_VERTEX_STRIDE];
+            glm::vec3 position = glm::vec3(model * glm::vec4(vertex[0], vertex[1], vertex[2], 1.0f));
+            // left unnormalized, like the shader leaves the per-instance normal
+            glm::vec3 normal = normal_matrix * glm::vec3(vertex[3], vertex[4], vertex[5]);
+            vertices.insert(vertices.end(), {position.x, position.y, position.z,
+                                             normal.x, normal.y, normal.z,
+                                             vertex[6], vertex[7]});
+        }
+        vertex_materials.insert(vertex_materials.end(), mesh->vertex_count, group_layers[i]);
+
+        for (unsigned int index : mesh->indices) {
+            indices.push_back(base + index);
+        }
+    }
+
+    std::string name = "static batch " + std::to_string(batches.size()) + " (" + group.front()->get_texture_name() + ")";
+    Mesh* mesh = MeshRegistry::acquire(name, vertices.data(), static_cast<int>(vertices.size() / MESH_VERTEX_STRIDE),
+                                       indices.data(), static_cast<int>(indices.size()), vertex_materials.data());
+    // with layers the texture of the batch itself is never sampled
+    return new Object(name, mesh, group.front()->get_texture_name());
+}
+
+void StaticBatcher::update() {
+    for (MaterialArray& array : arrays) {
+        if (!array.ID && std::none_of(array.layers.begin(), array.layers.end(),
+                                      [](const Texture* texture) { return texture->loading; })) {
+            fill(array);
+        }
+    }
+}
+
+void StaticBatcher::fill(MaterialArray& array) {
+    const TextureLayout& layout = array.layout;
+    auto layer_count = static_cast<int>(array.layers.size());
+
+    glGenTextures(1, &array.ID);
+    glActiveTexture(GL_TEXTURE0 + STATIC_MATERIAL_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, array.ID);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, layout.levels - 1);
+    for (int level = 0; level < layout.levels; level++) {
+        int width = std::max(1, layout.width >> level);
+        int height = std::max(1, layout.height >> level);
+        if (is_compressed(layout.format)) {
+            auto size = static_cast<GLsizei>(level_size(layout.format, width, height) * layer_count);
+            glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, layout.format, width, height, layer_count, 0, size, nullptr);
+        }
+        else {
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, layout.format, width, height, layer_count, 0,
+                         pixel_format(layout.format), GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+
+    // without ARB_copy_image every level goes through a pixel buffer, it never leaves the GPU either
+    unsigned int pbo = 0;
+    if (!ext_copy_image) {
+        glGenBuffers(1, &pbo);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    }
+    for (int layer = 0; layer < layer_count; layer++) {
+        const Texture* texture = array.layers[layer];
+        // a cooked file that appeared, or an image that failed to load, since build() probed it
+        if (!(texture->layout == layout)) {
+            std::cout << "Texture " << texture->path << " no longer matches its static material array, layer "
+                      << layer << " left empty" << std::endl;
+            continue;
+        }
+        copy_layer(texture, array, layer, pbo);
+    }
+    if (pbo) {
+        glDeleteBuffers(1, &pbo);
+    }
+    glActiveTexture(GL_TEXTURE0);
+
+    array.batch->set_material_array(array.ID);
+}
+
+// expects the array bound to the active unit
+void StaticBatcher::copy_layer(const Texture* texture, const MaterialArray& array, int layer, unsigned int pbo) {
+    const TextureLayout& layout = array.layout;
+    if (ext_copy_image) {
+        for (int level = 0; level < layout.levels; level++) {
+            glCopyImageSubData(texture->ID, GL_TEXTURE_2D, level, 0, 0, 0,
+                               array.ID, GL_TEXTURE_2D_ARRAY, level, 0, 0, layer,
+                               std::max(1, layout.width >> level), std::max(1, layout.height >> level), 1);
+        }
+        return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture->ID);
+    for (int level = 0; level < layout.levels; level++) {
+        int width = std::max(1, layout.width >> level);
+        int height = std::max(1, layout.height >> level);
+        auto size = static_cast<GLsizei>(level_size(layout.format, width, height));
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_COPY);
+        if (is_compressed(layout.format)) {
+            glGetCompressedTexImage(GL_TEXTURE_2D, level, nullptr);
+        }
+        else {
+            glGetTexImage(GL_TEXTURE_2D, level, pixel_format(layout.format), GL_UNSIGNED_BYTE, nullptr);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        if (is_compressed(layout.format)) {
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1, layout.format, size, nullptr);
+        }
+        else {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1,
+                            pixel_format(layout.format), GL_UNSIGNED_BYTE, nullptr);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void StaticBatcher::free() {
+    for (MaterialArray& array : arrays) {
+        for (Texture* texture : array.layers) {
+            TextureCache::release(texture);
+        }
+        if (array.ID) {
+            glDeleteTextures(1, &array.ID);
+        }
+    }
+    arrays.clear();
+    if (placeholder) {
+        glDeleteTextures(1, &placeholder);
+        placeholder = 0;
+    }
+
+    for (Object* batch : batches) {
+        batch->free();
+        delete batch;
+    }
+    batches.clear();
+}
@@ -0,0 +1,304 @@
+#include <iostream>
+#include <filesystem>
+#include <cstring>
+
+#include "headers/TextureCache.h"
+#include "headers/stb_image.h"
+#include "headers/CookedTexture.h"
+#include "headers/GLExtensions.h"
+
+std::unordered_map<std::string, Texture*> TextureCache::textures = {};
+std::unordered_map<std::string, std::string> TextureCache::normalized_paths = {};
+int TextureCache::hits = 0;
+int TextureCache::misses = 0;
+
+std::vector<std::thread> TextureCache::workers = {};
+std::queue<std::pair<std::string, std::string>> TextureCache::pending = {};
+std::vector<TextureCache::DecodedImage> TextureCache::decoded = {};
+std::mutex TextureCache::mutex;
+std::condition_variable TextureCache::work_available;
+bool TextureCache::stopping = false;
+int TextureCache::in_flight = 0;
+unsigned int TextureCache::pbo = 0;
+
+// the length of the chain glGenerateMipmap() builds
+static int mip_levels(int width, int height) {
+    int levels = 1;
+    while ((width | height) >> levels) {
+        levels++;
+    }
+    return levels;
+}
+
+Texture* TextureCache::acquire(const std::string& path) {
+    std::string key = normalize_path(path);
+
+    auto it = textures.find(key);
+    if (it != textures.end()) {
+        hits++;
+        it->second->references++;
+        return it->second;
+    }
+
+    misses++;
+    auto* texture = new Texture({key, create_placeholder(), 1, {GL_RGB8, 1, 1, 1}, true});
+    textures[key] = texture;
+
+    if (workers.empty()) {
+        start_workers();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.emplace(key, path);
+        in_flight++;
+    }
+    work_available.notify_one();
+    return texture;
+}
+
+void TextureCache::release(Texture* texture) {
+    if (--texture->references > 0) {
+        return;
+    }
+    glDeleteTextures(1, &texture->ID);
+    textures.erase(texture->path);
+    delete texture;
+}
+
+void TextureCache::update() {
+    std::vector<DecodedImage> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (decoded.empty()) {
+            return;
+        }
+        ready.swap(decoded);
+    }
+
+    for (const DecodedImage& image : ready) {
+        if (image.cooked) {
+            upload_cooked(image);
+        }
+        else if (image.pixels) {
+            upload(image);
+        }
+        else {
+            std::cout << "Failed to load texture " << image.key << std::endl;
+            auto it = textures.find(image.key);
+            if (it != textures.end()) {
+                it->second->loading = false;
+            }
+        }
+        stbi_image_free(image.pixels);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    in_flight -= static_cast<int>(ready.size());
+}
+
+bool TextureCache::is_loading() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return in_flight > 0;
+}
+
+void TextureCache::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_available.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    for (const DecodedImage& image : decoded) {
+        stbi_image_free(image.pixels);
+    }
+    decoded.clear();
+    if (pbo) {
+        glDeleteBuffers(1, &pbo);
+        pbo = 0;
+    }
+}
+
+// "../resources/a.jpg" and "../resources/./a.jpg" have to hit the same entry
+// weakly_canonical() asks the file system, large scenes repeat the same few paths many times
+std::string TextureCache::normalize_path(const std::string& path) {
+    auto cached = normalized_paths.find(path);
+    if (cached != normalized_paths.end()) {
+        return cached->second;
+    }
+
+    std::error_code error;
+    std::filesystem::path normalized = std::filesystem::weakly_canonical(path, error);
+    if (error) {
+        normalized = std::filesystem::path(path).lexically_normal();
+    }
+    return normalized_paths[path] = normalized.generic_string();
+}
+
+// a single grey texel is shown until the real image arrives
+unsigned int TextureCache::create_placeholder() {
+    const unsigned char grey[3] = {128, 128, 128};
+
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, grey);
+    return texture;
+}
+
+void TextureCache::upload(const DecodedImage& image) {
+    auto it = textures.find(image.key);
+    if (it == textures.end()) {
+        return; // released before it finished decoding
+    }
+
+    size_t size = static_cast<size_t>(image.width) * image.height * 3;
+    if (!pbo) {
+        glGenBuffers(1, &pbo);
+    }
+    // orphan the previous storage so the copy doesn't wait for the last upload to finish
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+    glBindTexture(GL_TEXTURE_2D, it->second->ID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (mapped) {
+        std::memcpy(mapped, image.pixels, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    else {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.pixels);
+    }
+    glGenerateMipmap(GL_TEXTURE_2D);
+    it->second->layout = {GL_RGB8, image.width, image.height, mip_levels(image.width, image.height)};
+    it->second->loading = false;
+}
+
+// every level comes from the file, glGenerateMipmap() isn't needed
+void TextureCache::upload_cooked(const DecodedImage& image) {
+    auto it = textures.find(image.key);
+    if (it == textures.end()) {
+        return;
+    }
+
+    const char* data = image.cooked->get_data();
+    const auto* header = reinterpret_cast<const CookedTextureHeader*>(data);
+    const auto* mips = reinterpret_cast<const CookedMip*>(data + sizeof(CookedTextureHeader));
+    GLenum format = cooked_format(data);
+
+    glBindTexture(GL_TEXTURE_2D, it->second->ID);
+    for (uint32_t level = 0; level < header->mip_count; level++) {
+        const CookedMip& mip = mips[level];
+        if (ext_texture_compression_s3tc) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, format, mip.width, mip.height, 0,
+                                   mip.compressed_size, data + mip.compressed_offset);
+        }
+        else {
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, mip.width, mip.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                         data + mip.fallback_offset);
+        }
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, header->mip_count - 1);
+    it->second->layout = {format, static_cast<int>(header->width), static_cast<int>(header->height),
+                          static_cast<int>(header->mip_count)};
+    it->second->loading = false;
+}
+
+// the internal format a cooked file is uploaded with, its RGBA8 fallback without S3TC support
+unsigned int TextureCache::cooked_format(const char* data) {
+    const auto* header = reinterpret_cast<const CookedTextureHeader*>(data);
+    if (!ext_texture_compression_s3tc) {
+        return GL_RGBA8;
+    }
+    return header->format == COOKED_BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+}
+
+bool TextureCache::probe(const std::string& path, TextureLayout& layout) {
+    std::shared_ptr<MappedFile> cooked = map_cooked(path);
+    if (cooked) {
+        const auto* header = reinterpret_cast<const CookedTextureHeader*>(cooked->get_data());
+        layout = {cooked_format(cooked->get_data()), static_cast<int>(header->width),
+                  static_cast<int>(header->height), static_cast<int>(header->mip_count)};
+        return true;
+    }
+
+    int width, height, channels;
+    if (!stbi_info(path.c_str(), &width, &height, &channels)) {
+        return false;
+    }
+    layout = {GL_RGB8, width, height, mip_levels(width, height)};
+    return true;
+}
+
+// the cooked form of an image, if there is one that is at least as new as the image
+std::shared_ptr<MappedFile> TextureCache::map_cooked(const std::string& path) {
+    std::string cooked_path = get_cooked_texture_path(path);
+    std::error_code error;
+    if (!std::filesystem::exists(cooked_path, error)) {
+        return nullptr;
+    }
+    auto source_time = std::filesystem::last_write_time(path, error);
+    if (!error && std::filesystem::last_write_time(cooked_path, error) < source_time) {
+        return nullptr;
+    }
+
+    auto cooked = std::make_shared<MappedFile>();
+    if (!cooked->open(cooked_path) || !is_valid_cooked_texture(cooked->get_data(), cooked->get_size())) {
+        return nullptr;
+    }
+    return cooked;
+}
+
+void TextureCache::start_workers() {
+    // leave one core to the GL thread
+    unsigned int cores = std::thread::hardware_concurrency();
+    unsigned int count = cores > 1 ? cores - 1 : 1;
+    for (unsigned int i = 0; i < count; i++) {
+        workers.emplace_back(decode_worker);
+    }
+}
+
+void TextureCache::decode_worker() {
+    stbi_set_flip_vertically_on_load_thread(true);
+
+    while (true) {
+        std::pair<std::string, std::string> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_available.wait(lock, [] { return stopping || !pending.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = pending.front();
+            pending.pop();
+        }
+
+        std::shared_ptr<MappedFile> cooked = map_cooked(job.second);
+        if (cooked) {
+            std::lock_guard<std::mutex> lock(mutex);
+            decoded.push_back({job.first, 0, 0, nullptr, cooked});
+            continue;
+        }
+
+        // always decode to RGB, grey or RGBA files would otherwise be uploaded with the wrong layout
+        int width = 0, height = 0, channels;
+        unsigned char* pixels = stbi_load(job.second.c_str(), &width, &height, &channels, 3);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        decoded.push_back({job.first, width, height, pixels, nullptr});
+    }
+}
@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "headers/TextureCooker.h"
+#include "headers/CookedTexture.h"
+#include "headers/stb_image.h"
+
+struct Image {
+    int width;
+    int height;
+    std::vector<unsigned char> pixels; // RGBA8
+};
+
+// next smaller level, every texel averages the 2x2 texels above it (1x2 or 2x1 at odd edges)
+static Image downsample(const Image& source) {
+    Image result = {std::max(1, source.width / 2), std::max(1, source.height / 2), {}};
+    result.pixels.resize(static_cast<size_t>(result.width) * result.height * 4);
+    for (int y = 0; y < result.height; y++) {
+        for (int x = 0; x < result.width; x++) {
+            int x0 = std::min(x * 2, source.width - 1), x1 = std::min(x * 2 + 1, source.width - 1);
+            int y0 = std::min(y * 2, source.height - 1), y1 = std::min(y * 2 + 1, source.height - 1);
+            for (int c = 0; c < 4; c++) {
+                int sum = source.pixels[(y0 * source.width + x0) * 4 + c] + source.pixels[(y0 * source.width + x1) * 4 + c]
+                        + source.pixels[(y1 * source.width + x0) * 4 + c] + source.pixels[(y1 * source.width + x1) * 4 + c];
+                result.pixels[(y * result.width + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+    return result;
+}
+
+static uint16_t pack_565(const float color[3]) {
+    int r = std::clamp((int) std::lround(color[0] * 31.0f / 255.0f), 0, 31);
+    int g = std::clamp((int) std::lround(color[1] * 63.0f / 255.0f), 0, 63);
+    int b = std::clamp((int) std::lround(color[2] * 31.0f / 255.0f), 0, 31);
+    return static_cast<uint16_t>(r << 11 | g << 5 | b);
+}
+
+static void unpack_565(uint16_t packed, int color[3]) {
+    int r = packed >> 11 & 31, g = packed >> 5 & 63, b = packed & 31;
+    color[0] = r << 3 | r >> 2;
+    color[1] = g << 2 | g >> 4;
+    color[2] = b << 3 | b >> 2;
+}
+
+static void write_16(unsigned char* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8 & 0xFF;
+}
+
+// BC1 color block: the endpoints are the extremes of the block along its principal axis, pulled in
+// by 1/16 of the range, every texel takes the closest of the four interpolated colors
+static void encode_color_block(const unsigned char block[16][4], unsigned char* out) {
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 3; c++) {
+            mean[c] += block[i][c] / 16.0f;
+        }
+    }
+    float covariance[6] = {0.0f}; // rr rg rb gg gb bb
+    for (int i = 0; i < 16; i++) {
+        float r = block[i][0] - mean[0], g = block[i][1] - mean[1], b = block[i][2] - mean[2];
+        covariance[0] += r * r; covariance[1] += r * g; covariance[2] += r * b;
+        covariance[3] += g * g; covariance[4] += g * b; covariance[5] += b * b;
+    }
+    // power iteration, starting from the covariance row of the channel that varies most
+    const int rows[3][3] = {{0, 1, 2}, {1, 3, 4}, {2, 4, 5}};
+    int channel = covariance[0] >= covariance[3] && covariance[0] >= covariance[5] ? 0 : covariance[3] >= covariance[5] ? 1 : 2;
+    float axis[3] = {covariance[rows[channel][0]], covariance[rows[channel][1]], covariance[rows[channel][2]]};
+    if (covariance[rows[channel][channel]] < 1e-6f) {
+        axis[0] = axis[1] = axis[2] = 1.0f;
+    }
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[3] = {covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+                         covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+                         covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2]};
+        float length = std::max({std::fabs(next[0]), std::fabs(next[1]), std::fabs(next[2])});
+        if (length < 1e-6f) {
+            break;
+        }
+        for (int c = 0; c < 3; c++) {
+            axis[c] = next[c] / length;
+        }
+    }
+
+    float low = INFINITY, high = -INFINITY;
+    for (int i = 0; i < 16; i++) {
+        float t = (block[i][0] - mean[0]) * axis[0] + (block[i][1] - mean[1]) * axis[1] + (block[i][2] - mean[2]) * axis[2];
+        low = std::min(low, t);
+        high = std::max(high, t);
+    }
+    float axis_length_squared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    float inset = (high - low) / 16.0f;
+    float endpoints[2][3];
+    for (int c = 0; c < 3; c++) {
+        endpoints[0][c] = mean[c] + axis[c] * (high - inset) / axis_length_squared;
+        endpoints[1][c] = mean[c] + axis[c] * (low + inset) / axis_length_squared;
+    }
+
+    // color0 > color1 selects the four color mode
+    uint16_t color0 = pack_565(endpoints[0]);
+    uint16_t color1 = pack_565(endpoints[1]);
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+    write_16(out, color0);
+    write_16(out + 2, color1);
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        int palette[4][3];
+        unpack_565(color0, palette[0]);
+        unpack_565(color1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0; i < 16; i++) {
+            int best = 0, best_distance = INT32_MAX;
+            for (int p = 0; p < 4; p++) {
+                int dr = block[i][0] - palette[p][0], dg = block[i][1] - palette[p][1], db = block[i][2] - palette[p][2];
+                int distance = dr * dr + dg * dg + db * db;
+                if (distance < best_distance) {
+                    best = p;
+                    best_distance = distance;
+                }
+            }
+            indices |= static_cast<uint32_t>(best) << (i * 2);
+        }
+    }
+    write_16(out + 4, indices & 0xFFFF);
+    write_16(out + 6, indices >> 16);
+}
+
+// BC3 alpha block: the alpha range of the block with six interpolated steps in between
+static void encode_alpha_block(const unsigned char block[16][4], unsigned char* out) {
+    int high = 0, low = 255;
+    for (int i = 0; i < 16; i++) {
+        high = std::max(high, (int) block[i][3]);
+        low = std::min(low, (int) block[i][3]);
+    }
+    out[0] = static_cast<unsigned char>(high);
+    out[1] = static_cast<unsigned char>(low);
+
+    uint64_t indices = 0;
+    if (high != low) {
+        int palette[8] = {high, low};
+        for (int p = 1; p < 7; p++) {
+            palette[p + 1] = ((7 - p) * high + p * low) / 7;
+        }
+        for (int i = 0; i < 16; i++) {
+            int best = 0, best_distance = INT32_MAX;
+            for (int p = 0; p < 8; p++) {
+                int distance = std::abs(block[i][3] - palette[p]);
+                if (distance < best_distance) {
+                    best = p;
+                    best_distance = distance;
+                }
+            }
+            indices |= static_cast<uint64_t>(best) << (i * 3);
+        }
+    }
+    for (int b = 0; b < 6; b++) {
+        out[2 + b] = static_cast<unsigned char>(indices >> (b * 8) & 0xFF);
+    }
+}
+
+static std::vector<unsigned char> encode(const Image& image, CookedTextureFormat format) {
+    int blocks_x = (image.width + 3) / 4;
+    int blocks_y = (image.height + 3) / 4;
+    size_t block_size = format == COOKED_BC1 ? 8 : 16;
+    std::vector<unsigned char> encoded(static_cast<size_t>(blocks_x) * blocks_y * block_size);
+
+    unsigned char block[16][4];
+    for (int by = 0; by < blocks_y; by++) {
+        for (int bx = 0; bx < blocks_x; bx++) {
+            // levels smaller than a block repeat their edge texels
+            for (int i = 0; i < 16; i++) {
+                int x = std::min(bx * 4 + i % 4, image.width - 1);
+                int y = std::min(by * 4 + i / 4, image.height - 1);
+                std::copy_n(&image.pixels[(static_cast<size_t>(y) * image.width + x) * 4], 4, block[i]);
+            }
+            unsigned char* out = &encoded[(static_cast<size_t>(by) * blocks_x + bx) * block_size];
+            if (format == COOKED_BC3) {
+                encode_alpha_block(block, out);
+                out += 8;
+            }
+            encode_color_block(block, out);
+        }
+    }
+    return encoded;
+}
+
+bool TextureCooker::cook(const std::string& source_path, const std::string& cooked_path) {
+    // same orientation as the images TextureCache decodes at runtime
+    stbi_set_flip_vertically_on_load(true);
+    int width, height, channels;
+    unsigned char* pixels = stbi_load(source_path.c_str(), &width, &height, &channels, 4);
+    if (!pixels) {
+        std::cout << "Failed to load " << source_path << ": " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+
+    Image level = {width, height, std::vector<unsigned char>(pixels, pixels + static_cast<size_t>(width) * height * 4)};
+    stbi_image_free(pixels);
+
+    bool has_alpha = false;
+    for (size_t i = 3; i < level.pixels.size(); i += 4) {
+        has_alpha = has_alpha || level.pixels[i] != 255;
+    }
+    CookedTextureFormat format = has_alpha ? COOKED_BC3 : COOKED_BC1;
+
+    std::vector<Image> chain = {level};
+    while (chain.back().width > 1 || chain.back().height > 1) {
+        chain.push_back(downsample(chain.back()));
+    }
+
+    CookedTextureHeader header = {};
+    std::memcpy(header.magic, COOKED_TEXTURE_MAGIC, sizeof(COOKED_TEXTURE_MAGIC));
+    header.version = COOKED_TEXTURE_VERSION;
+    header.format = format;
+    header.width = width;
+    header.height = height;
+    header.mip_count = static_cast<uint32_t>(chain.size());
+
+    std::vector<CookedMip> mips(chain.size());
+    std::vector<std::vector<unsigned char>> compressed(chain.size());
+    uint32_t offset = static_cast<uint32_t>(sizeof(CookedTextureHeader) + mips.size() * sizeof(CookedMip));
+    for (size_t i = 0; i < chain.size(); i++) {
+        compressed[i] = encode(chain[i], format);
+        mips[i].width = chain[i].width;
+        mips[i].height = chain[i].height;
+        mips[i].compressed_offset = offset;
+        mips[i].compressed_size = static_cast<uint32_t>(compressed[i].size());
+        offset += mips[i].compressed_size;
+    }
+    size_t compressed_total = offset;
+    for (size_t i = 0; i < chain.size(); i++) {
+        mips[i].fallback_offset = offset;
+        mips[i].fallback_size = static_cast<uint32_t>(chain[i].pixels.size());
+        offset += mips[i].fallback_size;
+    }
+
+    std::ofstream file(cooked_path, std::ios::binary);
+    if (!file) {
+        std::cout << "Failed to write " << cooked_path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(mips.data()), mips.size() * sizeof(CookedMip));
+    for (const auto& data : compressed) {
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+    for (const Image& image : chain) {
+        file.write(reinterpret_cast<const char*>(image.pixels.data()), image.pixels.size());
+    }
+    if (!file) {
+        std::cout << "Failed to write " << cooked_path << std::endl;
+        return false;
+    }
+
+    std::cout << source_path << " -> " << cooked_path << ": " << width << "x" << height << ", "
+              << chain.size() << " mips, " << (format == COOKED_BC1 ? "BC1 " : "BC3 ")
+              << (compressed_total - sizeof(CookedTextureHeader) - mips.size() * sizeof(CookedMip)) / 1024
+              << " KB, RGBA8 " << (offset - compressed_total) / 1024 << " KB" << std::endl;
+    return true;
+}
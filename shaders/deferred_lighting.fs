@@ -0,0 +1,43 @@
+#version 330 core
+// lighting pass of the deferred path: one full-screen pass that shades every covered pixel with the
+// directional light and the point lights of its cluster, like texture_shader.fs does per fragment.
+// The lighting functions come from lighting.glsl
+
+// written by the geometry pass, see DeferredRenderer
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+
+out vec4 FragColor;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    // nothing was drawn here, keep what the target was cleared to
+    if (depth == 1.0)
+        discard;
+
+    albedo = texelFetch(gAlbedo, pixel, 0).rgb;
+    vec4 normalShininess = texelFetch(gNormal, pixel, 0);
+    shininess = normalShininess.a;
+    vec3 norm = normalize(normalShininess.xyz);
+
+    vec2 uv = gl_FragCoord.xy / vec2(textureSize(gDepth, 0));
+    vec4 worldPos = inverseViewProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    vec3 fragPos = worldPos.xyz / worldPos.w;
+    vec3 viewDir = normalize(viewPos - fragPos);
+
+    // phase 1: Directional lighting
+    vec3 result = CalcDirLight(dirLight, norm, viewDir);
+    // phase 2: Point lights reaching this pixel's cluster
+    uvec2 lights = texelFetch(clusterGrid, ClusterIndex(fragPos)).rg;
+    for(uint i = 0u; i < lights.y; i++){
+        int index = int(texelFetch(clusterLightIndices, int(lights.x + i)).r);
+        result += CalcPointLight(FetchPointLight(index), norm, fragPos, viewDir);
+    }
+
+    FragColor = vec4(result, 1.0);
+    // the forward passes that follow depth test against the scene
+    gl_FragDepth = depth;
+}
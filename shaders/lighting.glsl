@@ -0,0 +1,113 @@
+// Lighting shared by texture_shader.fs and deferred_lighting.fs. Shader inserts this file after the
+// #version line of both, main() sets albedo and shininess before calling the Calc functions.
+struct DirLight {
+    vec3 direction;
+  
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};  
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);  
+
+struct PointLight {  
+    vec3 position;
+    float constant;
+
+    vec3 ambient;
+    float linear;
+
+    vec3 diffuse;
+    float quadratic;
+
+    vec3 specular;
+    float radius;
+};  
+// filled by PointLightManager::upload(), shared by every object drawn this frame
+layout (std140) uniform Lights {
+    DirLight dirLight;
+};
+// four texels per light, in the order of the PointLight members
+uniform samplerBuffer pointLightData;
+PointLight FetchPointLight(int index);
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir); 
+
+// light lists per cluster, filled by ClusterGrid::update()
+#define CLUSTER_X 16
+#define CLUSTER_Y 9
+#define CLUSTER_Z 24
+layout (std140) uniform Clusters {
+    vec2 tileSize;
+    float sliceScale;
+    float sliceBias;
+};
+uniform usamplerBuffer clusterGrid;         // offset, count
+uniform usamplerBuffer clusterLightIndices;
+int ClusterIndex(vec3 fragPos);
+
+layout (std140) uniform Camera {
+    mat4 projection;
+    mat4 view;
+    mat4 viewProjection;
+    vec3 viewPos;
+    mat4 inverseViewProjection;
+};
+
+vec3 albedo;
+float shininess;
+
+int ClusterIndex(vec3 fragPos)
+{
+    ivec2 tile = min(ivec2(gl_FragCoord.xy / tileSize), ivec2(CLUSTER_X - 1, CLUSTER_Y - 1));
+    float depth = -(view * vec4(fragPos, 1.0)).z;
+    int slice = clamp(int(floor(log(depth) * sliceScale + sliceBias)), 0, CLUSTER_Z - 1);
+    return tile.x + tile.y * CLUSTER_X + slice * CLUSTER_X * CLUSTER_Y;
+}
+
+PointLight FetchPointLight(int index)
+{
+    vec4 texel0 = texelFetch(pointLightData, index * 4);
+    vec4 texel1 = texelFetch(pointLightData, index * 4 + 1);
+    vec4 texel2 = texelFetch(pointLightData, index * 4 + 2);
+    vec4 texel3 = texelFetch(pointLightData, index * 4 + 3);
+    return PointLight(texel0.xyz, texel0.w, texel1.xyz, texel1.w, texel2.xyz, texel2.w, texel3.xyz, texel3.w);
+}
+
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
+{
+    vec3 lightDir = normalize(-light.direction);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    // combine results
+    vec3 ambient  = light.ambient  * albedo * 0.001;
+    vec3 diffuse  = light.diffuse  * diff * albedo;
+    vec3 specular = light.specular * spec * albedo;
+    return (ambient + diffuse + specular);
+}
+
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+{
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    // attenuation
+    float distance    = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + 
+  			     light.quadratic * (distance * distance));    
+    // shifted down to reach zero at the radius, so that clusters the light isn't listed in don't show an edge
+    float cutoff = 1.0 / (light.constant + light.linear * light.radius + light.quadratic * (light.radius * light.radius));
+    attenuation = max(attenuation - cutoff, 0.0) / (1.0 - cutoff);
+    // combine results
+    vec3 ambient  = light.ambient  * albedo;
+    vec3 diffuse  = light.diffuse  * diff * albedo;
+    vec3 specular = light.specular * spec * albedo;
+    ambient  *= attenuation;
+    diffuse  *= attenuation;
+    specular *= attenuation;
+    return (ambient + diffuse + specular);
+}
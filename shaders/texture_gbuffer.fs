@@ -0,0 +1,26 @@
+#version 330 core
+// geometry pass of the deferred path, runs with texture_shader.vs
+struct Material {
+    sampler2D diffuse;
+    float shininess;
+};
+uniform Material material;
+// the textures of the static batches, one layer each, see StaticBatcher
+uniform sampler2DArray staticMaterials;
+
+layout (location = 0) out vec4 gAlbedo;
+layout (location = 1) out vec4 gNormal;
+
+in vec2 TexCoords;
+in vec3 Normal;
+in vec3 FragPos;
+flat in int MaterialLayer;
+
+void main()
+{
+    vec3 albedo = MaterialLayer < 0 ? texture(material.diffuse, TexCoords).rgb
+                                    : texture(staticMaterials, vec3(TexCoords, MaterialLayer)).rgb;
+    gAlbedo = vec4(albedo, 1.0);
+    // world space normal, the shininess rides along in alpha
+    gNormal = vec4(normalize(Normal), material.shininess);
+}
@@ -2,10 +2,16 @@
 layout (location = 0) in vec3 aPos;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// filled once per frame by Camera::upload_uniforms()
+layout (std140) uniform Camera {
+    mat4 projection;
+    mat4 view;
+    mat4 viewProjection;
+    vec3 viewPos;
+    mat4 inverseViewProjection;
+};
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = viewProjection * model * vec4(aPos, 1.0);
 } 
\ No newline at end of file
@@ -1,36 +1,14 @@
 #version 330 core
+// the lights, the cluster lookup and CalcDirLight/CalcPointLight come from lighting.glsl
 struct Material {
     sampler2D diffuse;
     float shininess;
 }; 
 
-struct DirLight {
-    vec3 direction;
-  
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};  
-uniform DirLight dirLight;
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);  
-
-struct PointLight {  
-    bool on;
-
-    vec3 position;
-    
-    float constant;
-    float linear;
-    float quadratic;  
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};  
-#define NR_POINT_LIGHTS 100  
-uniform PointLight point_lights[NR_POINT_LIGHTS];
-uniform int pointLightsCount;
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir); 
+// per object light lists, shaded instead of the cluster's lights when set
+uniform bool objectLights;
+flat in ivec4 ObjectLights0;
+flat in ivec4 ObjectLights1;
 
 struct SpotLight {
     vec3 position;
@@ -50,26 +28,42 @@ uniform SpotLight spotLight;
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
 
 uniform Material material;
-uniform vec3 viewPos;
+// the textures of the static batches, one layer each, see StaticBatcher
+uniform sampler2DArray staticMaterials;
 
 out vec4 FragColor;
 
 in vec2 TexCoords;
 in vec3 Normal;
 in vec3 FragPos;  
+flat in int MaterialLayer;
 
 void main()
 {
+    albedo = MaterialLayer < 0 ? texture(material.diffuse, TexCoords).rgb
+                               : texture(staticMaterials, vec3(TexCoords, MaterialLayer)).rgb;
+    shininess = material.shininess;
     // properties
     vec3 norm = normalize(Normal);
     vec3 viewDir = normalize(viewPos - FragPos);
 
     // phase 1: Directional lighting
     vec3 result = CalcDirLight(dirLight, norm, viewDir);
-    // phase 2: Point lights
-    for(int i = 0; i < pointLightsCount; i++){
-        if (point_lights[i].on)
-            result += CalcPointLight(point_lights[i], norm, FragPos, viewDir);
+    // phase 2: Point lights reaching this object or this fragment's cluster
+    if (objectLights) {
+        for(int i = 0; i < 8; i++){
+            int index = i < 4 ? ObjectLights0[i] : ObjectLights1[i - 4];
+            if (index < 0)
+                break;
+            result += CalcPointLight(FetchPointLight(index), norm, FragPos, viewDir);
+        }
+    }
+    else {
+        uvec2 lights = texelFetch(clusterGrid, ClusterIndex(FragPos)).rg;
+        for(uint i = 0u; i < lights.y; i++){
+            int index = int(texelFetch(clusterLightIndices, int(lights.x + i)).r);
+            result += CalcPointLight(FetchPointLight(index), norm, FragPos, viewDir);
+        }
     }
     // phase 3: Spot light
     //result += CalcSpotLight(spotLight, norm, FragPos, viewDir);    
@@ -77,43 +71,6 @@ void main()
     FragColor = vec4(result, 1.0);
 }
 
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
-{
-    vec3 lightDir = normalize(-light.direction);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    // combine results
-    vec3 ambient  = light.ambient  * vec3(texture(material.diffuse, TexCoords)) * 0.001;
-    vec3 diffuse  = light.diffuse  * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.diffuse, TexCoords));
-    return (ambient + diffuse + specular);
-}
-
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
-{
-    vec3 lightDir = normalize(light.position - fragPos);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    // attenuation
-    float distance    = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + 
-  			     light.quadratic * (distance * distance));    
-    // combine results
-    vec3 ambient  = light.ambient  * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse  = light.diffuse  * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.diffuse, TexCoords));
-    ambient  *= attenuation;
-    diffuse  *= attenuation;
-    specular *= attenuation;
-    return (ambient + diffuse + specular);
-}
-
 // calculates the color when using a spot light.
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
 {
@@ -122,7 +79,7 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     float diff = max(dot(normal, lightDir), 0.0);
     // specular shading
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
     // attenuation
     float distance = length(light.position - fragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
@@ -131,9 +88,9 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     float epsilon = light.cutOff - light.outerCutOff;
     float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
     // combine results
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.diffuse, TexCoords));
+    vec3 ambient = light.ambient * albedo;
+    vec3 diffuse = light.diffuse * diff * albedo;
+    vec3 specular = light.specular * spec * albedo;
     ambient *= attenuation * intensity;
     diffuse *= attenuation * intensity;
     specular *= attenuation * intensity;
@@ -2,19 +2,39 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+// per-instance, written by InstancedRenderer
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in mat3 aNormalMatrix;
+// lights reaching the instance, -1 ends the list
+layout (location = 10) in ivec4 aLights0;
+layout (location = 11) in ivec4 aLights1;
+// layer of staticMaterials for merged static geometry, -1 samples material.diffuse
+layout (location = 12) in int aMaterialLayer;
 
 out vec3 Normal;
 out vec3 FragPos;   
 out vec2 TexCoords;
+flat out ivec4 ObjectLights0;
+flat out ivec4 ObjectLights1;
+flat out int MaterialLayer;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// filled once per frame by Camera::upload_uniforms()
+layout (std140) uniform Camera {
+    mat4 projection;
+    mat4 view;
+    mat4 viewProjection;
+    vec3 viewPos;
+    mat4 inverseViewProjection;
+};
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal; 
+    vec4 worldPos = aModel * vec4(aPos, 1.0);
+    gl_Position = viewProjection * worldPos;
+    FragPos = vec3(worldPos);
+    Normal = aNormalMatrix * aNormal;
     TexCoords = aTexCoords; 
+    ObjectLights0 = aLights0;
+    ObjectLights1 = aLights1;
+    MaterialLayer = aMaterialLayer;
 } 
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include "headers/CookedTexture.h"
+#include "headers/TextureCooker.h"
+
+// usage: asset_cook [--force] <image or directory>...
+// Cooks every image next to its source ("floor.jpg" -> "floor.ctex"), directories are searched
+// for .jpg, .jpeg, .png, .tga and .bmp files. Images whose cooked file is newer are skipped
+// unless --force is given.
+
+static bool is_image(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    for (char& c : extension) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".tga" || extension == ".bmp";
+}
+
+static bool cook_file(const std::filesystem::path& source, bool force, int& cooked, int& skipped) {
+    std::filesystem::path destination = get_cooked_texture_path(source.string());
+    std::error_code error;
+    if (!force && std::filesystem::exists(destination, error)
+        && std::filesystem::last_write_time(destination, error) >= std::filesystem::last_write_time(source, error)) {
+        skipped++;
+        return true;
+    }
+    if (!TextureCooker::cook(source.string(), destination.string())) {
+        return false;
+    }
+    cooked++;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool force = false;
+    bool success = true;
+    int cooked = 0, skipped = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--force") {
+            force = true;
+            continue;
+        }
+
+        std::filesystem::path path(argument);
+        if (std::filesystem::is_directory(path)) {
+            for (const auto& entry : std::filesystem::directory_iterator(path)) {
+                if (entry.is_regular_file() && is_image(entry.path())) {
+                    success = cook_file(entry.path(), force, cooked, skipped) && success;
+                }
+            }
+        }
+        else if (std::filesystem::is_regular_file(path)) {
+            success = cook_file(path, force, cooked, skipped) && success;
+        }
+        else {
+            std::cout << "No such file or directory: " << argument << std::endl;
+            success = false;
+        }
+    }
+
+    std::cout << "Cooked " << cooked << " textures, " << skipped << " up to date" << std::endl;
+    return success ? 0 : 1;
+}